@@ -0,0 +1,157 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"bench/bench_clock.h"
+#include"raid/llr_decoder.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This benchmark is run by `make autotune` against each
+candidate build of llr_xorgf.c, but also works on its own.
+
+For every variant this machine supports, it times a mix of
+encoding 10+4 stripes with llr_encode_fused and decoding
+two lost data blocks of them, streamed from more stripes
+than fit in cache.
+
+Each line of output is the variant name, then the encode,
+decode and combined throughput in GB/s of data blocks.
+The combined figure is total data over total time, so
+neither half dominates.
+The widest variant comes last.
+*/
+
+#define NUM_DATA 10
+#define NUM_PARITY 4
+#define NUM_LOST 2
+#define POOL_SIZE (64UL * 1024 * 1024)
+
+static char const* const isa_names[] = {
+	"generic", "sse2", "avx2", "avx512"
+};
+
+struct stripe {
+	void* data[NUM_DATA];
+	void* parity[NUM_PARITY];
+	void const* remaining[NUM_DATA];
+};
+
+static unsigned long long
+time_encode(struct stripe* stripes, unsigned int num_stripes,
+	    unsigned long long* iters) {
+	unsigned long long start = bench_now(), elapsed;
+	unsigned int s = 0;
+
+	*iters = 0;
+	do {
+		llr_encode_fused((void const* const*) stripes[s].data, NUM_DATA,
+				 stripes[s].parity, NUM_PARITY);
+		if (++s == num_stripes)
+			s = 0;
+		++*iters;
+		elapsed = bench_now() - start;
+	} while (elapsed < BENCH_MIN_NS);
+	return elapsed;
+}
+
+static unsigned long long
+time_decode(llr_decoder const* decoder, void* const* lost,
+	    struct stripe* stripes, unsigned int num_stripes,
+	    unsigned long long* iters) {
+	unsigned long long start = bench_now(), elapsed;
+	unsigned int s = 0;
+
+	*iters = 0;
+	do {
+		llr_decoder_decode(decoder, lost, stripes[s].remaining);
+		if (++s == num_stripes)
+			s = 0;
+		++*iters;
+		elapsed = bench_now() - start;
+	} while (elapsed < BENCH_MIN_NS);
+	return elapsed;
+}
+
+int main(void) {
+	static unsigned int const lost_data[NUM_LOST] = { 2, 7 };
+	unsigned int num_stripes = POOL_SIZE /
+				   ((NUM_DATA + NUM_PARITY) * LLR_XORGF_BLOCK_SIZE);
+	struct stripe* stripes = malloc(num_stripes * sizeof(struct stripe));
+	unsigned int matrix_storage_size, scratch_space_size;
+	unsigned char* matrix_storage;
+	unsigned char* scratch_space;
+	void* lost[NUM_LOST];
+	llr_decoder decoder;
+	unsigned int s, i, j, r, l;
+	int isa;
+
+	for (s = 0; s < num_stripes; ++s) {
+		for (i = 0; i < NUM_DATA; ++i) {
+			stripes[s].data[i] = malloc(LLR_XORGF_BLOCK_SIZE);
+			memcpy(stripes[s].data[i],
+			       llr_testvectors_sampledata[(i + s) % 8],
+			       LLR_XORGF_BLOCK_SIZE);
+		}
+		for (j = 0; j < NUM_PARITY; ++j)
+			stripes[s].parity[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+		llr_encode((void const* const*) stripes[s].data, NUM_DATA,
+			   stripes[s].parity, NUM_PARITY);
+		/* The surviving data, then the first parity blocks.  */
+		r = 0;
+		for (i = 0, l = 0; i < NUM_DATA; ++i) {
+			if (l < NUM_LOST && lost_data[l] == i)
+				++l;
+			else
+				stripes[s].remaining[r++] = stripes[s].data[i];
+		}
+		for (j = 0; r < NUM_DATA; ++j)
+			stripes[s].remaining[r++] = stripes[s].parity[j];
+	}
+	for (l = 0; l < NUM_LOST; ++l)
+		lost[l] = malloc(LLR_XORGF_BLOCK_SIZE);
+
+	llr_decoder_sizes(&matrix_storage_size, &scratch_space_size,
+			  NUM_DATA, NUM_PARITY, lost_data, NUM_LOST, NULL, 0);
+	matrix_storage = malloc(matrix_storage_size);
+	scratch_space = malloc(scratch_space_size);
+	llr_decoder_init(&decoder, NUM_DATA, NUM_PARITY, lost_data, NUM_LOST,
+			 NULL, 0, matrix_storage, scratch_space);
+
+	for (isa = llr_xorgf_isa_generic; isa <= llr_xorgf_isa_max; ++isa) {
+		unsigned long long enc_ns, dec_ns, enc_iters, dec_iters;
+		double enc_bytes, dec_bytes;
+
+		if (!llr_xorgf_isa_supported((enum llr_xorgf_isa) isa))
+			continue;
+		llr_xorgf_set_isa((enum llr_xorgf_isa) isa);
+
+		enc_ns = time_encode(stripes, num_stripes, &enc_iters);
+		dec_ns = time_decode(&decoder, lost, stripes, num_stripes,
+				     &dec_iters);
+
+		/* Sanity check.  */
+		llr_decoder_decode(&decoder, lost, stripes[0].remaining);
+		for (l = 0; l < NUM_LOST; ++l) {
+			if (memcmp(lost[l], stripes[0].data[lost_data[l]],
+				   LLR_XORGF_BLOCK_SIZE) != 0) {
+				fprintf(stderr, "%s: decode mismatch!\n",
+					isa_names[isa]);
+				return 1;
+			}
+		}
+
+		enc_bytes = (double) enc_iters * NUM_DATA * LLR_XORGF_BLOCK_SIZE;
+		dec_bytes = (double) dec_iters * NUM_DATA * LLR_XORGF_BLOCK_SIZE;
+		printf("%s %.2f %.2f %.2f\n", isa_names[isa],
+		       enc_bytes / (double) enc_ns,
+		       dec_bytes / (double) dec_ns,
+		       (enc_bytes + dec_bytes) / (double) (enc_ns + dec_ns));
+	}
+
+	return 0;
+}
@@ -0,0 +1,51 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#if !defined(BENCH_BENCH_CLOCK_H_)
+#define BENCH_BENCH_CLOCK_H_
+#include<time.h>
+
+/*
+This module provides the timer shared by the
+userspace benchmarks.
+*/
+
+/** bench_now
+ *
+ * @brief Returns a monotonic timestamp, in nanoseconds.
+ */
+static inline
+unsigned long long bench_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long) ts.tv_sec) * 1000000000ULL +
+	       (unsigned long long) ts.tv_nsec;
+}
+
+/** BENCH_MIN_NS
+ *
+ * @brief How long each measurement should run for,
+ * at least.
+ */
+#define BENCH_MIN_NS 200000000ULL
+
+#endif /* !defined(BENCH_BENCH_CLOCK_H_) */
@@ -0,0 +1,145 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"bench/bench_clock.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This benchmark compares llr_encode against
+llr_encode_fused and llr_encode_plan_run on a few common
+layouts.
+
+Throughput is reported in GB/s of data blocks
+encoded.
+"hot" encodes the same stripe over and over, so
+everything stays in cache.
+"cold" cycles through enough stripes that they
+have to be streamed from memory.
+*/
+
+/* Total size of the stripes cycled through in the
+ * "cold" measurement; should be well above the size
+ * of the last-level cache.  */
+#define COLD_POOL_SIZE (256UL * 1024 * 1024)
+
+typedef void (*encode_func)(void const* const*, unsigned int,
+			    void* const*, unsigned int);
+
+/* The plan used by plan_encode, for the layout being
+ * measured.  */
+static llr_encode_plan plan;
+
+static void
+plan_encode(void const* const* data_blocks, unsigned int num_data_blocks,
+	    void* const* parity_blocks, unsigned int num_parity_blocks) {
+	llr_encode_plan_run(&plan, data_blocks, parity_blocks);
+}
+
+struct stripe {
+	void** data;
+	void** parity;
+};
+
+static double
+measure(encode_func encode,
+	struct stripe const* stripes, unsigned int num_stripes,
+	unsigned int num_data_blocks, unsigned int num_parity_blocks) {
+	unsigned long long start, elapsed;
+	unsigned long long iters = 0;
+	unsigned int s = 0;
+
+	start = bench_now();
+	do {
+		encode((void const* const*) stripes[s].data, num_data_blocks,
+		       stripes[s].parity, num_parity_blocks);
+		if (++s == num_stripes)
+			s = 0;
+		++iters;
+		elapsed = bench_now() - start;
+	} while (elapsed < BENCH_MIN_NS);
+
+	return ((double) iters * num_data_blocks * LLR_XORGF_BLOCK_SIZE) /
+	       (double) elapsed;
+}
+
+int main(void) {
+	static unsigned int const layouts[][2] = {
+		{4, 1}, {6, 2}, {8, 2}, {10, 4}, {16, 4}, {32, 8}
+	};
+	unsigned int l, s, i, j;
+
+	printf("%-8s %14s %14s %14s %14s %14s %14s\n", "layout",
+	       "encode hot", "fused hot", "plan hot",
+	       "encode cold", "fused cold", "plan cold");
+	for (l = 0; l < sizeof(layouts) / sizeof(layouts[0]); ++l) {
+		unsigned int k = layouts[l][0];
+		unsigned int m = layouts[l][1];
+		unsigned int num_stripes = COLD_POOL_SIZE /
+					   ((k + m) * LLR_XORGF_BLOCK_SIZE);
+		struct stripe* stripes = malloc(num_stripes * sizeof(struct stripe));
+		void** check = malloc(m * sizeof(void*));
+		void* plan_storage = malloc(llr_encode_plan_size(k, m));
+		double results[6];
+		char name[16];
+
+		for (s = 0; s < num_stripes; ++s) {
+			stripes[s].data = malloc(k * sizeof(void*));
+			stripes[s].parity = malloc(m * sizeof(void*));
+			for (i = 0; i < k; ++i) {
+				stripes[s].data[i] = malloc(LLR_XORGF_BLOCK_SIZE);
+				memcpy(stripes[s].data[i],
+				       llr_testvectors_sampledata[(i + s) % 8],
+				       LLR_XORGF_BLOCK_SIZE);
+			}
+			for (j = 0; j < m; ++j)
+				stripes[s].parity[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+		}
+		for (j = 0; j < m; ++j)
+			check[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+
+		llr_encode_plan_init(&plan, k, m, plan_storage);
+
+		results[0] = measure(&llr_encode, stripes, 1, k, m);
+		results[1] = measure(&llr_encode_fused, stripes, 1, k, m);
+		results[2] = measure(&plan_encode, stripes, 1, k, m);
+		results[3] = measure(&llr_encode, stripes, num_stripes, k, m);
+		results[4] = measure(&llr_encode_fused, stripes, num_stripes, k, m);
+		results[5] = measure(&plan_encode, stripes, num_stripes, k, m);
+
+		/* Sanity check.  */
+		llr_encode((void const* const*) stripes[0].data, k, check, m);
+		for (j = 0; j < m; ++j) {
+			if (memcmp(stripes[0].parity[j], check[j], LLR_XORGF_BLOCK_SIZE) != 0) {
+				fprintf(stderr, "%u+%u: parity %u mismatch!\n",
+					k, m, j);
+				return 1;
+			}
+		}
+
+		snprintf(name, sizeof(name), "%u+%u", k, m);
+		printf("%-8s %9.2f GB/s %9.2f GB/s %9.2f GB/s %9.2f GB/s %9.2f GB/s %9.2f GB/s\n",
+		       name, results[0], results[1], results[2],
+		       results[3], results[4], results[5]);
+
+		for (j = 0; j < m; ++j)
+			free(check[j]);
+		for (s = 0; s < num_stripes; ++s) {
+			for (j = 0; j < m; ++j)
+				free(stripes[s].parity[j]);
+			for (i = 0; i < k; ++i)
+				free(stripes[s].data[i]);
+			free(stripes[s].parity);
+			free(stripes[s].data);
+		}
+		free(check);
+		free(stripes);
+		free(plan_storage);
+	}
+
+	return 0;
+}
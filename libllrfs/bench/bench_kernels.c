@@ -0,0 +1,147 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"bench/bench_clock.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This benchmark compares the unrolled and compact
+multiplier kernels (see enum llr_xorgf_kernels) on
+layouts of increasing width, so that a deployment can
+pick the one that suits it.
+
+Wider stripes use more distinct factors, so more of
+the unrolled kernels compete for the instruction cache,
+while the compact kernel stays the same size.
+
+Throughput is reported in GB/s of data blocks encoded,
+with llr_encode_fused and with llr_encode_plan_run.
+The stripes cycled through are larger than the last-level
+cache, as in the "cold" measurement of bench_encode.
+*/
+
+#define POOL_SIZE (256UL * 1024 * 1024)
+
+struct stripe {
+	void** data;
+	void** parity;
+};
+
+static double
+measure(llr_encode_plan const* plan,
+	struct stripe const* stripes, unsigned int num_stripes,
+	unsigned int num_data_blocks, unsigned int num_parity_blocks) {
+	unsigned long long start, elapsed;
+	unsigned long long iters = 0;
+	unsigned int s = 0;
+
+	start = bench_now();
+	do {
+		if (plan)
+			llr_encode_plan_run(plan,
+					    (void const* const*) stripes[s].data,
+					    stripes[s].parity);
+		else
+			llr_encode_fused((void const* const*) stripes[s].data,
+					 num_data_blocks,
+					 stripes[s].parity, num_parity_blocks);
+		if (++s == num_stripes)
+			s = 0;
+		++iters;
+		elapsed = bench_now() - start;
+	} while (elapsed < BENCH_MIN_NS);
+
+	return ((double) iters * num_data_blocks * LLR_XORGF_BLOCK_SIZE) /
+	       (double) elapsed;
+}
+
+int main(void) {
+	static unsigned int const layouts[][2] = {
+		{8, 2}, {16, 4}, {32, 8}, {64, 16}, {128, 16}
+	};
+	enum llr_xorgf_kernels orig = llr_xorgf_get_kernels();
+	unsigned int l, s, i, j;
+
+	printf("%-8s %16s %16s %16s %16s\n", "layout",
+	       "unrolled fused", "compact fused",
+	       "unrolled plan", "compact plan");
+	for (l = 0; l < sizeof(layouts) / sizeof(layouts[0]); ++l) {
+		unsigned int k = layouts[l][0];
+		unsigned int m = layouts[l][1];
+		unsigned int num_stripes = POOL_SIZE /
+					   ((k + m) * LLR_XORGF_BLOCK_SIZE);
+		struct stripe* stripes = malloc(num_stripes * sizeof(struct stripe));
+		void** check = malloc(m * sizeof(void*));
+		llr_encode_plan plan;
+		void* plan_storage = malloc(llr_encode_plan_size(k, m));
+		double results[4];
+		char name[16];
+
+		for (s = 0; s < num_stripes; ++s) {
+			stripes[s].data = malloc(k * sizeof(void*));
+			stripes[s].parity = malloc(m * sizeof(void*));
+			for (i = 0; i < k; ++i) {
+				stripes[s].data[i] = malloc(LLR_XORGF_BLOCK_SIZE);
+				memcpy(stripes[s].data[i],
+				       llr_testvectors_sampledata[(i + s) % 8],
+				       LLR_XORGF_BLOCK_SIZE);
+			}
+			for (j = 0; j < m; ++j)
+				stripes[s].parity[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+		}
+		for (j = 0; j < m; ++j)
+			check[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+
+		/* Plans capture the kernels, so build one after
+		 * every switch.  */
+		llr_xorgf_set_kernels(llr_xorgf_kernels_unrolled);
+		llr_encode_plan_init(&plan, k, m, plan_storage);
+		results[0] = measure(NULL, stripes, num_stripes, k, m);
+		results[2] = measure(&plan, stripes, num_stripes, k, m);
+
+		llr_xorgf_set_kernels(llr_xorgf_kernels_compact);
+		llr_encode_plan_init(&plan, k, m, plan_storage);
+		results[1] = measure(NULL, stripes, num_stripes, k, m);
+		results[3] = measure(&plan, stripes, num_stripes, k, m);
+
+		/* Sanity check: the compact plan against the
+		 * unrolled reference.  */
+		llr_xorgf_set_kernels(llr_xorgf_kernels_unrolled);
+		llr_encode((void const* const*) stripes[0].data, k, check, m);
+		llr_encode_plan_run(&plan, (void const* const*) stripes[0].data,
+				    stripes[0].parity);
+		for (j = 0; j < m; ++j) {
+			if (memcmp(stripes[0].parity[j], check[j], LLR_XORGF_BLOCK_SIZE) != 0) {
+				fprintf(stderr, "%u+%u: parity %u mismatch!\n",
+					k, m, j);
+				return 1;
+			}
+		}
+
+		snprintf(name, sizeof(name), "%u+%u", k, m);
+		printf("%-8s %11.2f GB/s %11.2f GB/s %11.2f GB/s %11.2f GB/s\n",
+		       name, results[0], results[1], results[2], results[3]);
+
+		for (j = 0; j < m; ++j)
+			free(check[j]);
+		for (s = 0; s < num_stripes; ++s) {
+			for (j = 0; j < m; ++j)
+				free(stripes[s].parity[j]);
+			for (i = 0; i < k; ++i)
+				free(stripes[s].data[i]);
+			free(stripes[s].parity);
+			free(stripes[s].data);
+		}
+		free(check);
+		free(stripes);
+		free(plan_storage);
+	}
+	llr_xorgf_set_kernels(orig);
+
+	return 0;
+}
@@ -0,0 +1,146 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"bench/bench_clock.h"
+#include"raid/llr_decoder.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_verify.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This benchmark compares llr_locate against finding a bad
+data block by trial and error: rebuild each data block in
+turn from the others and parity 0, and keep the one that
+makes the whole stripe verify.
+
+The stripe is 16+3 with a single bad data block, at the
+start, middle, or end of the stripe; trial and error
+finds an early block sooner.
+
+Times are reported in microseconds per stripe.
+*/
+
+#define K 16
+#define M 3
+
+static void const* data_blocks[K];
+static void* parity_blocks[M];
+static unsigned char* scratch;
+static unsigned char* rebuilt;
+static unsigned char* matrix_storage;
+static unsigned char* decoder_scratch;
+
+static unsigned int
+locate_syndrome(void) {
+	unsigned int bad = 0;
+	llr_locate(data_blocks, K, (void const* const*) parity_blocks, M,
+		   scratch, &bad);
+	return bad;
+}
+
+static unsigned int
+locate_trial(void) {
+	void const* remaining[K + M];
+	void const* trial[K];
+	unsigned char mismatches[(M + 7) / 8];
+	unsigned int no_parity[1];
+	unsigned int e, i, r;
+
+	if (!llr_verify(data_blocks, K, (void const* const*) parity_blocks, M,
+			scratch, mismatches))
+		return K;
+	/* Only one parity block is wrong.  */
+	if ((mismatches[0] & (mismatches[0] - 1)) == 0)
+		return K;
+
+	for (e = 0; e < K; ++e) {
+		llr_decoder decoder;
+
+		r = 0;
+		for (i = 0; i < K; ++i) {
+			if (i != e)
+				remaining[r++] = data_blocks[i];
+			trial[i] = data_blocks[i];
+		}
+		for (i = 0; i < M; ++i)
+			remaining[r++] = parity_blocks[i];
+
+		llr_decoder_init(&decoder, K, M, &e, 1, no_parity, 0,
+				 matrix_storage, decoder_scratch);
+		llr_decoder_decode(&decoder, (void* const*) &rebuilt, remaining);
+		trial[e] = rebuilt;
+		if (!llr_verify(trial, K, (void const* const*) parity_blocks, M,
+				scratch, NULL))
+			return e;
+	}
+	return K;
+}
+
+static double
+measure(unsigned int (*locate)(void), unsigned int expected) {
+	unsigned long long start, elapsed;
+	unsigned long long iters = 0;
+
+	start = bench_now();
+	do {
+		if (locate() != expected) {
+			fprintf(stderr, "located the wrong block\n");
+			exit(1);
+		}
+		++iters;
+		elapsed = bench_now() - start;
+	} while (elapsed < BENCH_MIN_NS);
+
+	return (double) elapsed / (double) iters / 1000.0;
+}
+
+int main(void) {
+	static unsigned int const bad_blocks[] = { 0, K / 2, K - 1 };
+	unsigned char* bad_data = malloc(LLR_XORGF_BLOCK_SIZE);
+	unsigned int matrix_storage_size, decoder_scratch_size;
+	unsigned int b, i;
+
+	for (i = 0; i < K; ++i)
+		data_blocks[i] = llr_testvectors_sampledata[i % 8];
+	for (i = 0; i < M; ++i)
+		parity_blocks[i] = malloc(LLR_XORGF_BLOCK_SIZE);
+	llr_encode(data_blocks, K, parity_blocks, M);
+
+	scratch = malloc(llr_locate_scratch_size(M));
+	rebuilt = malloc(LLR_XORGF_BLOCK_SIZE);
+	llr_decoder_max_sizes(&matrix_storage_size, &decoder_scratch_size, K);
+	matrix_storage = malloc(matrix_storage_size);
+	decoder_scratch = malloc(decoder_scratch_size);
+
+	printf("%-10s %14s %14s\n", "bad block", "locate", "trial");
+	for (b = 0; b < sizeof(bad_blocks) / sizeof(bad_blocks[0]); ++b) {
+		unsigned int e = bad_blocks[b];
+		void const* orig = data_blocks[e];
+		double syndrome, trial;
+
+		/* Damage a run of bytes, as a bad sector might.  */
+		memcpy(bad_data, orig, LLR_XORGF_BLOCK_SIZE);
+		for (i = 1024; i < 1536; ++i)
+			bad_data[i] ^= 0x5A;
+		data_blocks[e] = bad_data;
+
+		syndrome = measure(&locate_syndrome, e);
+		trial = measure(&locate_trial, e);
+		printf("%-10u %11.2f us %11.2f us\n", e, syndrome, trial);
+
+		data_blocks[e] = orig;
+	}
+
+	free(decoder_scratch);
+	free(matrix_storage);
+	free(rebuilt);
+	free(scratch);
+	for (i = 0; i < M; ++i)
+		free(parity_blocks[i]);
+	free(bad_data);
+	return 0;
+}
@@ -0,0 +1,76 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"bench/bench_clock.h"
+#include"raid/llr_cauchy.h"
+#include"raid/llr_matrix_inverse.h"
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This benchmark times llr_matrix_inverse_compute on the
+kind of matrix the decoder builds, for widths from 8 to
+128.
+
+"half lost" keeps the identity rows of every other data
+block, and fills the rest with Cauchy rows.
+"all lost" is made of Cauchy rows only, which is the
+worst case.
+*/
+
+static void
+make_matrix(unsigned char* mat, unsigned int w, int all_lost) {
+	unsigned int k, row, parity;
+
+	memset(mat, 0, w * w);
+	row = 0;
+	if (!all_lost) {
+		for (k = 0; k < w; k += 2) {
+			mat[k + row * w] = 1;
+			++row;
+		}
+	}
+	for (parity = 0; row < w; ++parity, ++row) {
+		for (k = 0; k < w; ++k)
+			mat[k + row * w] = llr_cauchy(k, parity);
+	}
+}
+
+static double
+measure(unsigned int w, int all_lost) {
+	unsigned char* orig = malloc(w * w);
+	unsigned char* mat = malloc(w * w);
+	unsigned char* scratch = malloc(llr_matrix_inverse_scratch_space_size(w));
+	unsigned long long start, elapsed;
+	unsigned long long iters = 0;
+
+	make_matrix(orig, w, all_lost);
+
+	start = bench_now();
+	do {
+		memcpy(mat, orig, w * w);
+		llr_matrix_inverse_compute(w, scratch, mat);
+		++iters;
+		elapsed = bench_now() - start;
+	} while (elapsed < BENCH_MIN_NS);
+
+	free(scratch);
+	free(mat);
+	free(orig);
+
+	/* Microseconds per inversion.  */
+	return (double) elapsed / (double) iters / 1000.0;
+}
+
+int main(void) {
+	unsigned int w;
+
+	printf("%-6s %16s %16s\n", "width", "half lost", "all lost");
+	for (w = 8; w <= 128; w *= 2) {
+		printf("%-6u %13.2f us %13.2f us\n", w,
+		       measure(w, 0), measure(w, 1));
+	}
+
+	return 0;
+}
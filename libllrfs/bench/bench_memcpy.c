@@ -0,0 +1,106 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"bench/bench_clock.h"
+#include"llr_util.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This benchmark compares llr_memcpy and llr_memzero, and
+their non-temporal variants, against the plain byte loops
+they used to be, on single blocks.
+
+"hot" writes to the same block over and over.
+"cold" writes through a pool of blocks much larger than
+the caches, which is where non-temporal stores help.
+
+Throughput is reported in GB/s of bytes written.
+*/
+
+/* Total size of the blocks cycled through in the "cold"
+ * measurement; should be well above the size of the
+ * last-level cache.  */
+#define COLD_POOL_SIZE (256UL * 1024 * 1024)
+
+/* The old byte loops, for reference.
+ * The attribute keeps the compiler from turning them into
+ * calls to memcpy and memset.  */
+__attribute__((optimize("no-tree-loop-distribute-patterns")))
+static void
+byte_memcpy(void* restrict vdst, void const* restrict vsrc, unsigned int nbytes) {
+	char* dst = (char*) vdst;
+	char const* src = (char const*) vsrc;
+	for (; nbytes != 0; --nbytes, ++dst, ++src)
+		*dst = *src;
+}
+
+__attribute__((optimize("no-tree-loop-distribute-patterns")))
+static void
+byte_memzero(void* vdst, unsigned int nbytes) {
+	char* dst = (char*) vdst;
+	for (; nbytes != 0; --nbytes, ++dst)
+		*dst = 0;
+}
+
+typedef void (*copy_func)(void* restrict, void const* restrict, unsigned int);
+typedef void (*zero_func)(void*, unsigned int);
+
+static unsigned char* pool;
+
+static double
+measure(copy_func copy, zero_func zero, unsigned int num_blocks) {
+	unsigned long long start, elapsed;
+	unsigned long long iters = 0;
+	unsigned int b = 0;
+
+	start = bench_now();
+	do {
+		void* dst = &pool[(size_t) b * LLR_XORGF_BLOCK_SIZE];
+		if (copy)
+			copy(dst, llr_testvectors_sampledata[b % 8],
+			     LLR_XORGF_BLOCK_SIZE);
+		else
+			zero(dst, LLR_XORGF_BLOCK_SIZE);
+		if (++b == num_blocks)
+			b = 0;
+		++iters;
+		elapsed = bench_now() - start;
+	} while (elapsed < BENCH_MIN_NS);
+
+	return ((double) iters * LLR_XORGF_BLOCK_SIZE) / (double) elapsed;
+}
+
+int main(void) {
+	static struct {
+		char const* name;
+		copy_func copy;
+		zero_func zero;
+	} const funcs[] = {
+		{ "byte memcpy", &byte_memcpy, NULL },
+		{ "llr_memcpy", &llr_memcpy, NULL },
+		{ "llr_memcpy_nt", &llr_memcpy_nt, NULL },
+		{ "byte memzero", NULL, &byte_memzero },
+		{ "llr_memzero", NULL, &llr_memzero },
+		{ "llr_memzero_nt", NULL, &llr_memzero_nt }
+	};
+	unsigned int num_blocks = COLD_POOL_SIZE / LLR_XORGF_BLOCK_SIZE;
+	unsigned int f;
+
+	pool = malloc(COLD_POOL_SIZE);
+	/* Fault the pool in before measuring.  */
+	memset(pool, 0, COLD_POOL_SIZE);
+
+	printf("%-16s %14s %14s\n", "function", "hot", "cold");
+	for (f = 0; f < sizeof(funcs) / sizeof(funcs[0]); ++f) {
+		double hot = measure(funcs[f].copy, funcs[f].zero, 1);
+		double cold = measure(funcs[f].copy, funcs[f].zero, num_blocks);
+		printf("%-16s %9.2f GB/s %9.2f GB/s\n", funcs[f].name, hot, cold);
+	}
+
+	free(pool);
+	return 0;
+}
@@ -0,0 +1,371 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"bench/bench_clock.h"
+#include"raid/llr_decoder.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This benchmark sweeps the raid module over several layouts,
+erasure counts, working set sizes and kernel instruction
+sets, and prints the results as JSON, so that runs from
+different versions can be compared by a script.
+
+Usage: bench_raid [milliseconds per measurement]
+
+For each operation it reports:
+
+- "gbps": throughput in GB/s.
+  The bytes counted are the data blocks of the stripe, or
+  for llr_encode_modify the one changed block.
+- "cycles_per_byte": timestamp counter ticks per byte, on
+  x86 only.
+- "p50_ns", "p99_ns": latency of single calls.
+
+llr_decoder_init does not touch any blocks, so only its
+latency is reported.
+
+Working sets: "hot" reuses a single stripe, so it stays in
+cache; "cold" cycles through enough stripes that they have
+to be streamed from memory.
+
+The instruction sets are selected at runtime with
+llr_xorgf_set_isa, so a single build covers every
+`LLR_XORGF_VECTOR_SIZE` the processor supports.
+*/
+
+/* Total size of the stripes cycled through in the
+ * "cold" measurement; should be well above the size
+ * of the last-level cache.  */
+#define COLD_POOL_SIZE (256UL * 1024 * 1024)
+
+/* The most per-call latencies to keep.  */
+#define MAX_SAMPLES (1U << 20)
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define HAVE_TSC 1
+static inline
+unsigned long long bench_ticks(void) {
+	return __builtin_ia32_rdtsc();
+}
+#endif
+
+static unsigned long long min_ns = BENCH_MIN_NS;
+static unsigned long long* samples;
+static int first_result = 1;
+
+struct layout {
+	unsigned int num_data;
+	unsigned int num_parity;
+};
+
+static struct layout const layouts[] = {
+	{ 4, 2 }, { 8, 2 }, { 16, 4 }, { 32, 8 }
+};
+
+static char const* const isa_names[] = {
+	"generic", "sse2", "avx2", "avx512"
+};
+
+/* A pool of stripes, stored contiguously: the data blocks
+ * of each stripe, then its parity blocks.  */
+struct pool {
+	unsigned int num_data;
+	unsigned int num_parity;
+	unsigned int num_stripes;
+	unsigned char* blocks;
+	void const** data;
+	void** parity;
+};
+
+static void
+pool_init(struct pool* p, struct layout const* l, unsigned int num_stripes) {
+	unsigned int n = l->num_data + l->num_parity;
+	unsigned int s, i;
+
+	p->num_data = l->num_data;
+	p->num_parity = l->num_parity;
+	p->num_stripes = num_stripes;
+	p->blocks = malloc((size_t) num_stripes * n * LLR_XORGF_BLOCK_SIZE);
+	p->data = malloc((size_t) num_stripes * l->num_data * sizeof(void*));
+	p->parity = malloc((size_t) num_stripes * l->num_parity * sizeof(void*));
+
+	for (s = 0; s < num_stripes; ++s) {
+		unsigned char* stripe = &p->blocks[(size_t) s * n * LLR_XORGF_BLOCK_SIZE];
+		for (i = 0; i < l->num_data; ++i) {
+			unsigned char* block = &stripe[i * LLR_XORGF_BLOCK_SIZE];
+			memcpy(block, llr_testvectors_sampledata[(s + i) % 8],
+			       LLR_XORGF_BLOCK_SIZE);
+			p->data[s * l->num_data + i] = block;
+		}
+		for (i = 0; i < l->num_parity; ++i)
+			p->parity[s * l->num_parity + i] =
+				&stripe[(l->num_data + i) * LLR_XORGF_BLOCK_SIZE];
+		llr_encode(&p->data[s * l->num_data], l->num_data,
+			   &p->parity[s * l->num_parity], l->num_parity);
+	}
+}
+
+static void
+pool_free(struct pool* p) {
+	free(p->parity);
+	free(p->data);
+	free(p->blocks);
+}
+
+/* The operations being measured.  */
+struct op_ctx {
+	struct pool* pool;
+	unsigned char const* delta;
+	llr_decoder* decoder;
+	unsigned int const* lost;
+	unsigned int num_lost;
+	unsigned char* matrix_storage;
+	unsigned char* scratch_space;
+	void const** remaining;
+	/* Recovered blocks go here, for every stripe.  */
+	void** recovered;
+};
+
+typedef void (*op_func)(struct op_ctx* ctx, unsigned int s);
+
+static void
+op_encode(struct op_ctx* ctx, unsigned int s) {
+	struct pool* p = ctx->pool;
+	llr_encode(&p->data[s * p->num_data], p->num_data,
+		   &p->parity[s * p->num_parity], p->num_parity);
+}
+
+static void
+op_modify(struct op_ctx* ctx, unsigned int s) {
+	struct pool* p = ctx->pool;
+	llr_encode_modify(ctx->delta, s % p->num_data,
+			  &p->parity[s * p->num_parity], p->num_parity);
+}
+
+static void
+op_decoder_init(struct op_ctx* ctx, unsigned int s) {
+	struct pool* p = ctx->pool;
+	(void) s;
+	llr_decoder_init(ctx->decoder, p->num_data, p->num_parity,
+			 ctx->lost, ctx->num_lost, NULL, 0,
+			 ctx->matrix_storage, ctx->scratch_space);
+}
+
+static void
+op_decode(struct op_ctx* ctx, unsigned int s) {
+	struct pool* p = ctx->pool;
+	unsigned int i, n = 0, l = 0;
+
+	for (i = 0; i < p->num_data; ++i) {
+		if (l < ctx->num_lost && ctx->lost[l] == i)
+			++l;
+		else
+			ctx->remaining[n++] = p->data[s * p->num_data + i];
+	}
+	for (i = 0; i < p->num_parity; ++i)
+		ctx->remaining[n++] = p->parity[s * p->num_parity + i];
+	llr_decoder_decode(ctx->decoder, ctx->recovered, ctx->remaining);
+}
+
+static int
+compare_ull(void const* va, void const* vb) {
+	unsigned long long a = *(unsigned long long const*) va;
+	unsigned long long b = *(unsigned long long const*) vb;
+	return (a > b) - (a < b);
+}
+
+static void
+measure(char const* op_name, op_func op, struct op_ctx* ctx,
+	char const* isa, char const* working_set,
+	unsigned int num_lost, unsigned long long bytes_per_call) {
+	struct pool* p = ctx->pool;
+	unsigned long long start, elapsed, prev, now;
+	unsigned long long iters = 0;
+	unsigned int num_samples = 0;
+	unsigned int s = 0;
+#if defined(HAVE_TSC)
+	unsigned long long start_ticks = bench_ticks();
+	unsigned long long ticks;
+#endif
+
+	start = prev = bench_now();
+	do {
+		op(ctx, s);
+		if (++s == p->num_stripes)
+			s = 0;
+		++iters;
+		now = bench_now();
+		if (num_samples < MAX_SAMPLES)
+			samples[num_samples++] = now - prev;
+		prev = now;
+		elapsed = now - start;
+	} while (elapsed < min_ns);
+#if defined(HAVE_TSC)
+	ticks = bench_ticks() - start_ticks;
+#endif
+
+	qsort(samples, num_samples, sizeof(samples[0]), &compare_ull);
+
+	printf("%s\n    {\"op\": \"%s\", \"isa\": \"%s\", "
+	       "\"data\": %u, \"parity\": %u, \"lost\": %u, "
+	       "\"working_set\": \"%s\", \"stripes\": %u, \"calls\": %llu, ",
+	       first_result ? "" : ",",
+	       op_name, isa, p->num_data, p->num_parity, num_lost,
+	       working_set, p->num_stripes, iters);
+	first_result = 0;
+	if (bytes_per_call != 0) {
+		printf("\"gbps\": %.3f, ",
+		       (double) (iters * bytes_per_call) / (double) elapsed);
+#if defined(HAVE_TSC)
+		printf("\"cycles_per_byte\": %.4f, ",
+		       (double) ticks / (double) (iters * bytes_per_call));
+#else
+		printf("\"cycles_per_byte\": null, ");
+#endif
+	} else {
+		printf("\"gbps\": null, \"cycles_per_byte\": null, ");
+	}
+	printf("\"p50_ns\": %llu, \"p99_ns\": %llu}",
+	       samples[num_samples / 2],
+	       samples[(unsigned long long) num_samples * 99 / 100]);
+}
+
+/* Erasure counts to try: 1, half the parity, all the
+ * parity, without repeats.  */
+static unsigned int
+erasure_counts(unsigned int num_parity, unsigned int* counts) {
+	unsigned int n = 0;
+	counts[n++] = 1;
+	if (num_parity / 2 > 1)
+		counts[n++] = num_parity / 2;
+	if (num_parity > counts[n - 1])
+		counts[n++] = num_parity;
+	return n;
+}
+
+/* Check that decoding really recovers the data.  */
+static int
+check_decode(struct op_ctx* ctx) {
+	struct pool* p = ctx->pool;
+	unsigned int i;
+
+	op_decode(ctx, 0);
+	for (i = 0; i < ctx->num_lost; ++i) {
+		if (memcmp(ctx->recovered[i], p->data[ctx->lost[i]],
+			   LLR_XORGF_BLOCK_SIZE) != 0)
+			return 0;
+	}
+	return 1;
+}
+
+static int
+run_layout(struct layout const* l) {
+	static char const* const working_sets[] = { "hot", "cold" };
+	unsigned int n = l->num_data + l->num_parity;
+	unsigned int counts[3], num_counts, c, ws, i;
+	unsigned int lost[LLR_DECODER_MAX_BLOCKS];
+	unsigned int matrix_storage_size, scratch_space_size;
+	struct op_ctx ctx;
+	llr_decoder decoder;
+	int isa;
+
+	ctx.delta = llr_testvectors_sampledata[7];
+	ctx.decoder = &decoder;
+	ctx.lost = lost;
+	llr_decoder_max_sizes(&matrix_storage_size, &scratch_space_size,
+			      l->num_data);
+	ctx.matrix_storage = malloc(matrix_storage_size + 1);
+	ctx.scratch_space = malloc(scratch_space_size + 1);
+	ctx.remaining = malloc(n * sizeof(void*));
+	ctx.recovered = malloc(l->num_parity * sizeof(void*));
+	for (i = 0; i < l->num_parity; ++i)
+		ctx.recovered[i] = malloc(LLR_XORGF_BLOCK_SIZE);
+	num_counts = erasure_counts(l->num_parity, counts);
+
+	for (ws = 0; ws < 2; ++ws) {
+		struct pool p;
+		pool_init(&p, l, ws == 0 ? 1 :
+			  COLD_POOL_SIZE / (n * LLR_XORGF_BLOCK_SIZE));
+		ctx.pool = &p;
+
+		for (isa = llr_xorgf_isa_generic; isa <= llr_xorgf_isa_max; ++isa) {
+			if (!llr_xorgf_isa_supported((enum llr_xorgf_isa) isa))
+				continue;
+			llr_xorgf_set_isa((enum llr_xorgf_isa) isa);
+
+			measure("encode", &op_encode, &ctx,
+				isa_names[isa], working_sets[ws], 0,
+				(unsigned long long) l->num_data * LLR_XORGF_BLOCK_SIZE);
+			measure("encode_modify", &op_modify, &ctx,
+				isa_names[isa], working_sets[ws], 0,
+				LLR_XORGF_BLOCK_SIZE);
+
+			for (c = 0; c < num_counts; ++c) {
+				/* Spread the lost blocks out.  */
+				ctx.num_lost = counts[c];
+				for (i = 0; i < counts[c]; ++i)
+					lost[i] = i * l->num_data / counts[c];
+				op_decoder_init(&ctx, 0);
+				/* The parity was just changed by the
+				 * modify, so encode again before
+				 * checking.  */
+				op_encode(&ctx, 0);
+				if (!check_decode(&ctx)) {
+					fprintf(stderr, "%u+%u: decode mismatch!\n",
+						l->num_data, l->num_parity);
+					return 1;
+				}
+				measure("decode", &op_decode, &ctx,
+					isa_names[isa], working_sets[ws], counts[c],
+					(unsigned long long) l->num_data * LLR_XORGF_BLOCK_SIZE);
+			}
+		}
+
+		/* Initialization does not depend on the kernels or
+		 * on the data, so only measure it once.  */
+		if (ws == 0) {
+			for (c = 0; c < num_counts; ++c) {
+				ctx.num_lost = counts[c];
+				for (i = 0; i < counts[c]; ++i)
+					lost[i] = i * l->num_data / counts[c];
+				measure("decoder_init", &op_decoder_init, &ctx,
+					"none", working_sets[ws], counts[c], 0);
+			}
+		}
+
+		pool_free(&p);
+	}
+
+	for (i = 0; i < l->num_parity; ++i)
+		free(ctx.recovered[i]);
+	free(ctx.recovered);
+	free(ctx.remaining);
+	free(ctx.scratch_space);
+	free(ctx.matrix_storage);
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	enum llr_xorgf_isa best = llr_xorgf_get_isa();
+	unsigned int l;
+	int ret = 0;
+
+	if (argc >= 2)
+		min_ns = strtoull(argv[1], NULL, 10) * 1000000ULL;
+	samples = malloc(MAX_SAMPLES * sizeof(samples[0]));
+
+	printf("{\n  \"block_size\": %u,\n  \"results\": [", LLR_XORGF_BLOCK_SIZE);
+	for (l = 0; l < sizeof(layouts) / sizeof(layouts[0]) && !ret; ++l)
+		ret = run_layout(&layouts[l]);
+	printf("\n  ]\n}\n");
+
+	llr_xorgf_set_isa(best);
+	free(samples);
+	return ret;
+}
@@ -23,19 +23,135 @@ SOFTWARE.
 # include"config.h"
 #endif /* defined(HAVE_CONFIG_H) */
 #include"llr_util.h"
+#include<stdint.h>
+
+#if defined(__KERNEL__)
+# include<linux/string.h>
+# define LLR_UTIL_USE_STRING 1
+#elif defined(HAVE_STRING_H) && !defined(LLR_UTIL_FREESTANDING)
+# include<string.h>
+# define LLR_UTIL_USE_STRING 1
+#endif
+
+#if defined(LLR_UTIL_USE_STRING)
+
+void llr_memcpy(void* restrict dst, void const* restrict src, unsigned int nbytes) {
+	memcpy(dst, src, nbytes);
+}
+
+void llr_memzero(void* dst, unsigned int nbytes) {
+	memset(dst, 0, nbytes);
+}
+
+#else /* !defined(LLR_UTIL_USE_STRING) */
+
+/* Our own loops.
+ * When both buffers are aligned to a machine word, work a
+ * word at a time, then finish off the tail byte by byte.
+ * The word type has to be allowed to alias anything.
+ */
+#if defined(__GNUC__)
+typedef uintptr_t __attribute__((may_alias)) llr_util_word;
+# define LLR_UTIL_WORD_LOOPS 1
+#endif
 
-/* Most basic possible implementation.  We should use better ones
-depending on the environment we are compiling in.
-*/
 void llr_memcpy(void* restrict vdst, void const* restrict vsrc, unsigned int nbytes) {
 	char* dst = (char*) vdst;
 	char const* src = (char const*) vsrc;
+#if defined(LLR_UTIL_WORD_LOOPS)
+	if ((((uintptr_t) dst | (uintptr_t) src) % sizeof(llr_util_word)) == 0) {
+		llr_util_word* wdst = (llr_util_word*) dst;
+		llr_util_word const* wsrc = (llr_util_word const*) src;
+		for (; nbytes >= sizeof(llr_util_word);
+		     nbytes -= sizeof(llr_util_word), ++wdst, ++wsrc)
+			*wdst = *wsrc;
+		dst = (char*) wdst;
+		src = (char const*) wsrc;
+	}
+#endif
 	for (; nbytes != 0; --nbytes, ++dst, ++src)
 		*dst = *src;
 }
 
 void llr_memzero(void* vdst, unsigned int nbytes) {
 	char* dst = (char*) vdst;
+#if defined(LLR_UTIL_WORD_LOOPS)
+	if (((uintptr_t) dst % sizeof(llr_util_word)) == 0) {
+		llr_util_word* wdst = (llr_util_word*) dst;
+		for (; nbytes >= sizeof(llr_util_word);
+		     nbytes -= sizeof(llr_util_word), ++wdst)
+			*wdst = 0;
+		dst = (char*) wdst;
+	}
+#endif
 	for (; nbytes != 0; --nbytes, ++dst)
 		*dst = 0;
 }
+
+#endif /* !defined(LLR_UTIL_USE_STRING) */
+
+/* Non-temporal stores.
+ * MOVNTI is part of SSE2, which every x86-64 processor has,
+ * and it uses integer registers, so it is safe in kernel code
+ * that must not touch the SIMD state.
+ * We emit it with inline assembly because the compiler
+ * builtins are unavailable under -mno-sse2, which kernel
+ * builds use.
+ */
+#if defined(__GNUC__) && defined(__x86_64__)
+
+static inline
+void movnti(long long* dst, long long word) {
+	__asm__ __volatile__("movnti %1, %0" : "=m" (*dst) : "r" (word));
+}
+
+static inline
+void sfence(void) {
+	__asm__ __volatile__("sfence" : : : "memory");
+}
+
+void llr_memcpy_nt(void* restrict vdst, void const* restrict vsrc, unsigned int nbytes) {
+	long long* dst = (long long*) vdst;
+	long long const* src = (long long const*) vsrc;
+	unsigned int tail = nbytes % 8;
+
+	if ((uintptr_t) dst % 8 != 0) {
+		llr_memcpy(vdst, vsrc, nbytes);
+		return;
+	}
+	for (nbytes /= 8; nbytes != 0; --nbytes, ++dst, ++src) {
+		long long word;
+		/* src may not be aligned.  */
+		__builtin_memcpy(&word, src, 8);
+		movnti(dst, word);
+	}
+	/* Make the stores visible before we return.  */
+	sfence();
+	llr_memcpy(dst, src, tail);
+}
+
+void llr_memzero_nt(void* vdst, unsigned int nbytes) {
+	long long* dst = (long long*) vdst;
+	unsigned int tail = nbytes % 8;
+
+	if ((uintptr_t) dst % 8 != 0) {
+		llr_memzero(vdst, nbytes);
+		return;
+	}
+	for (nbytes /= 8; nbytes != 0; --nbytes, ++dst)
+		movnti(dst, 0);
+	sfence();
+	llr_memzero(dst, tail);
+}
+
+#else /* !(defined(__GNUC__) && defined(__x86_64__)) */
+
+void llr_memcpy_nt(void* restrict dst, void const* restrict src, unsigned int nbytes) {
+	llr_memcpy(dst, src, nbytes);
+}
+
+void llr_memzero_nt(void* dst, unsigned int nbytes) {
+	llr_memzero(dst, nbytes);
+}
+
+#endif /* !(defined(__GNUC__) && defined(__x86_64__)) */
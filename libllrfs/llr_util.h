@@ -29,10 +29,16 @@ This module provides basic memory utilities.
 These utilities are traditionally in <string.h>, but some
 environments may not provide this, or provide their own
 version.
-*/
 
-/* TODO: Use <string.h> if available, or a specific version
-if we are being compiled for that environment.
+The implementation is chosen at build time:
+
+- Linux kernel builds (`__KERNEL__`) use the kernel's own
+  `memcpy` and `memset`.
+- Hosted builds with <string.h> (`HAVE_STRING_H` from
+  configure) use the C library.
+- Otherwise, or if `LLR_UTIL_FREESTANDING` is defined, we
+  use our own loops, which work a machine word at a time
+  when the buffers are suitably aligned.
 */
 
 /** llr_memcpy
@@ -56,4 +62,31 @@ void llr_memcpy(void* restrict dst, void const* restrict src, unsigned int nbyte
  */
 void llr_memzero(void* dst, unsigned int nbytes);
 
+/** llr_memcpy_nt
+ *
+ * @brief Like `llr_memcpy`, but hints that `dst` will not
+ * be read again soon.
+ *
+ * @desc Where supported (x86-64 with a GCC-compatible
+ * compiler), this uses non-temporal stores that bypass the
+ * cache, so that writing out whole blocks, e.g. before they
+ * are handed to a device, does not evict data that is still
+ * in use.
+ * Elsewhere, or if `dst` is not 8-byte aligned, this is just
+ * `llr_memcpy`.
+ *
+ * Use this only for buffers that are not read back soon;
+ * otherwise the next read has to go all the way to memory.
+ */
+void llr_memcpy_nt(void* restrict dst, void const* restrict src, unsigned int nbytes);
+
+/** llr_memzero_nt
+ *
+ * @brief Like `llr_memzero`, but hints that `dst` will not
+ * be read again soon.
+ *
+ * @desc See `llr_memcpy_nt`.
+ */
+void llr_memzero_nt(void* dst, unsigned int nbytes);
+
 #endif /* !defined(LLR_UTIL_H_) */
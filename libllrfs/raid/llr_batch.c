@@ -0,0 +1,226 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"llr_batch.h"
+#include"llr_encode.h"
+#include"llr_xorgf.h"
+#include<stdint.h>
+
+/*
+Each worker owns a range [lo, hi) of stripe indices, packed
+into a single 64-bit word so that it can be updated with a
+single compare-and-swap.
+The owner takes stripes from the low end, and thieves take
+the upper half.
+Each stripe index is handed out exactly once, so a range
+that a thief read earlier can never reappear in a slot,
+and compare-and-swap is enough to avoid races.
+*/
+
+struct batch {
+	uint64_t ranges[LLR_BATCH_MAX_WORKERS];
+	unsigned int num_workers;
+	unsigned int steals;
+
+	/* Process one stripe.  */
+	void (*process)(struct batch const* b, unsigned int i);
+
+	/* For encoding.  */
+	struct llr_batch_encode_stripe const* encode_stripes;
+	unsigned int num_data_blocks;
+	unsigned int num_parity_blocks;
+
+	/* For decoding.  */
+	llr_decoder const* decoder;
+	struct llr_batch_decode_stripe const* decode_stripes;
+};
+
+static inline
+uint64_t range_pack(uint32_t lo, uint32_t hi) {
+	return (((uint64_t) hi) << 32) | lo;
+}
+static inline
+uint32_t range_lo(uint64_t r) {
+	return (uint32_t) r;
+}
+static inline
+uint32_t range_hi(uint64_t r) {
+	return (uint32_t) (r >> 32);
+}
+
+/* Take the next stripe from our own range.  */
+static
+int take_own(struct batch* b, unsigned int w, unsigned int* i) {
+	uint64_t r = __atomic_load_n(&b->ranges[w], __ATOMIC_ACQUIRE);
+	for (;;) {
+		uint32_t lo = range_lo(r);
+		uint32_t hi = range_hi(r);
+		if (lo >= hi)
+			return 0;
+		/* On failure, r is updated with the current
+		 * range.  */
+		if (__atomic_compare_exchange_n(&b->ranges[w], &r,
+						range_pack(lo + 1, hi),
+						0,
+						__ATOMIC_ACQ_REL,
+						__ATOMIC_ACQUIRE)) {
+			*i = lo;
+			return 1;
+		}
+	}
+}
+
+/* Our own range is empty; move the upper half of another
+ * worker's range into it.  */
+static
+int steal(struct batch* b, unsigned int w) {
+	unsigned int n;
+	for (n = 1; n < b->num_workers; ++n) {
+		unsigned int v = (w + n) % b->num_workers;
+		uint64_t r = __atomic_load_n(&b->ranges[v], __ATOMIC_ACQUIRE);
+		for (;;) {
+			uint32_t lo = range_lo(r);
+			uint32_t hi = range_hi(r);
+			uint32_t mid = lo + (hi - lo) / 2;
+			if (lo >= hi)
+				break;
+			if (__atomic_compare_exchange_n(&b->ranges[v], &r,
+							range_pack(lo, mid),
+							0,
+							__ATOMIC_ACQ_REL,
+							__ATOMIC_ACQUIRE)) {
+				/* Our range is empty, so no thief will
+				 * try to update it.  */
+				__atomic_store_n(&b->ranges[w],
+						 range_pack(mid, hi),
+						 __ATOMIC_RELEASE);
+				__atomic_fetch_add(&b->steals, 1,
+						   __ATOMIC_RELAXED);
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+static
+void worker(void* arg, unsigned int w) {
+	struct batch* b = (struct batch*) arg;
+	unsigned int i;
+
+	do {
+		while (take_own(b, w, &i))
+			b->process(b, i);
+	} while (steal(b, w));
+}
+
+static
+void run_batch(struct llr_batch_host const* host,
+	       struct batch* b,
+	       unsigned int num_stripes,
+	       unsigned long long bytes,
+	       struct llr_batch_stats* stats) {
+	unsigned long long start = 0;
+	unsigned int w;
+
+	/* No point having more workers than stripes.  */
+	b->num_workers = host->num_workers;
+	if (b->num_workers > LLR_BATCH_MAX_WORKERS)
+		b->num_workers = LLR_BATCH_MAX_WORKERS;
+	if (b->num_workers > num_stripes)
+		b->num_workers = num_stripes;
+	if (b->num_workers == 0)
+		b->num_workers = 1;
+
+	/* Split the stripes evenly.  */
+	for (w = 0; w < b->num_workers; ++w) {
+		uint32_t lo = (uint64_t) num_stripes * w / b->num_workers;
+		uint32_t hi = (uint64_t) num_stripes * (w + 1) / b->num_workers;
+		b->ranges[w] = range_pack(lo, hi);
+	}
+	b->steals = 0;
+
+	if (host->now_ns)
+		start = host->now_ns(host->ctx);
+	if (b->num_workers == 1)
+		worker(b, 0);
+	else
+		host->run(host->ctx, b->num_workers, &worker, b);
+
+	if (stats) {
+		stats->bytes = bytes;
+		stats->ns = host->now_ns ? host->now_ns(host->ctx) - start : 0;
+		stats->steals = b->steals;
+	}
+}
+
+static
+void process_encode(struct batch const* b, unsigned int i) {
+	llr_encode(b->encode_stripes[i].data_blocks, b->num_data_blocks,
+		   b->encode_stripes[i].parity_blocks, b->num_parity_blocks);
+}
+
+void llr_batch_encode(struct llr_batch_host const* host,
+		      struct llr_batch_encode_stripe const* stripes,
+		      unsigned int num_stripes,
+		      unsigned int num_data_blocks,
+		      unsigned int num_parity_blocks,
+		      struct llr_batch_stats* stats) {
+	struct batch b;
+
+	b.process = &process_encode;
+	b.encode_stripes = stripes;
+	b.num_data_blocks = num_data_blocks;
+	b.num_parity_blocks = num_parity_blocks;
+
+	run_batch(host, &b, num_stripes,
+		  (unsigned long long) num_stripes * num_data_blocks *
+		  LLR_XORGF_BLOCK_SIZE,
+		  stats);
+}
+
+static
+void process_decode(struct batch const* b, unsigned int i) {
+	llr_decoder_decode(b->decoder,
+			   b->decode_stripes[i].lost_data_blocks,
+			   b->decode_stripes[i].remaining_blocks);
+}
+
+void llr_batch_decode(struct llr_batch_host const* host,
+		      llr_decoder const* decoder,
+		      struct llr_batch_decode_stripe const* stripes,
+		      unsigned int num_stripes,
+		      struct llr_batch_stats* stats) {
+	struct batch b;
+
+	b.process = &process_decode;
+	b.decoder = decoder;
+	b.decode_stripes = stripes;
+
+	run_batch(host, &b, num_stripes,
+		  (unsigned long long) num_stripes *
+		  (decoder->num_lost_data_blocks +
+		   decoder->num_lost_parity_blocks) * LLR_XORGF_BLOCK_SIZE,
+		  stats);
+}
@@ -0,0 +1,169 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#if !defined(RAID_LLR_BATCH_H_)
+#define RAID_LLR_BATCH_H_
+#include"llr_decoder.h"
+
+/*
+This module encodes or decodes a batch of stripes, spreading
+the stripes across several workers.
+
+This library does not create threads itself.
+Instead, the host environment provides the threading
+primitives via `llr_batch_host`, just as `llr_util`
+abstracts the memory primitives.
+A pthreads-based host is in `userspace/llr_batch_pthread`.
+
+Each worker starts with an equal share of the stripes.
+A worker that finishes its share early steals half of the
+remaining stripes of another worker, so a slow worker does
+not hold up the whole batch.
+*/
+
+/** LLR_BATCH_MAX_WORKERS
+ *
+ * @brief The maximum number of workers a batch may be
+ * spread across.
+ * More workers in `llr_batch_host` are ignored.
+ */
+#define LLR_BATCH_MAX_WORKERS 64
+
+/** typedef llr_batch_worker_func
+ *
+ * @brief The function that each worker must run.
+ *
+ * @param arg - the argument given to `run`.
+ * @param worker - the index of the worker, from 0 to
+ * `num_workers - 1`.
+ */
+typedef void (*llr_batch_worker_func)(void* arg, unsigned int worker);
+
+/** struct llr_batch_host
+ *
+ * @brief Hooks for the host environment to run
+ * workers and measure time.
+ */
+struct llr_batch_host {
+	/** Run `func(arg, worker)` once for each `worker` from 0
+	 * to `num_workers - 1`, possibly in parallel, and
+	 * return only after all of them have returned.
+	 * The calling thread may run one of them itself.  */
+	void (*run)(void* ctx,
+		    unsigned int num_workers,
+		    llr_batch_worker_func func,
+		    void* arg);
+	/** Return a monotonic time in nanoseconds.
+	 * May be NULL if the host has no clock, in which case
+	 * no time is reported.  */
+	unsigned long long (*now_ns)(void* ctx);
+	/** Passed to the hooks above.  */
+	void* ctx;
+	/** The number of workers to use.
+	 * `1 <= num_workers`  */
+	unsigned int num_workers;
+};
+
+/** struct llr_batch_stats
+ *
+ * @brief The throughput of a batch.
+ */
+struct llr_batch_stats {
+	/** The number of data bytes encoded or recovered.  */
+	unsigned long long bytes;
+	/** The wall-clock time the batch took, in
+	 * nanoseconds, or 0 if the host has no clock.  */
+	unsigned long long ns;
+	/** The number of times a worker stole stripes from
+	 * another worker.  */
+	unsigned int steals;
+};
+
+/** struct llr_batch_encode_stripe
+ *
+ * @brief One stripe to encode.
+ * The arguments are as for `llr_encode`.
+ */
+struct llr_batch_encode_stripe {
+	void const* const* data_blocks;
+	void* const* parity_blocks;
+};
+
+/** struct llr_batch_decode_stripe
+ *
+ * @brief One stripe to decode.
+ * The arguments are as for `llr_decoder_decode`.
+ */
+struct llr_batch_decode_stripe {
+	void* const* lost_data_blocks;
+	void const* const* remaining_blocks;
+};
+
+/** llr_batch_encode
+ *
+ * @brief Encode several stripes with the same shape.
+ *
+ * @param host - input, the host hooks.
+ * @param stripes - input, the stripes to encode.
+ * Every stripe must use distinct parity blocks.
+ * @param num_stripes - input, the number of stripes.
+ * @param num_data_blocks - input, the number of data blocks
+ * in each stripe.
+ * @param num_parity_blocks - input, the number of parity
+ * blocks in each stripe.
+ * @param stats - output, the throughput of the batch.
+ * May be NULL.
+ *
+ * @desc The result is the same as calling `llr_encode` on
+ * each stripe in turn.
+ */
+void llr_batch_encode(struct llr_batch_host const* host,
+		      struct llr_batch_encode_stripe const* stripes,
+		      unsigned int num_stripes,
+		      unsigned int num_data_blocks,
+		      unsigned int num_parity_blocks,
+		      struct llr_batch_stats* stats);
+
+/** llr_batch_decode
+ *
+ * @brief Decode several stripes with the same pattern of
+ * lost blocks.
+ *
+ * @param host - input, the host hooks.
+ * @param decoder - input, the decoder for the pattern of
+ * lost blocks.
+ * @param stripes - input, the stripes to decode.
+ * Every stripe must use distinct lost data blocks.
+ * @param num_stripes - input, the number of stripes.
+ * @param stats - output, the throughput of the batch.
+ * May be NULL.
+ *
+ * @desc The result is the same as calling
+ * `llr_decoder_decode` on each stripe in turn.
+ */
+void llr_batch_decode(struct llr_batch_host const* host,
+		      llr_decoder const* decoder,
+		      struct llr_batch_decode_stripe const* stripes,
+		      unsigned int num_stripes,
+		      struct llr_batch_stats* stats);
+
+#endif /* !defined(RAID_LLR_BATCH_H_) */
@@ -192,7 +192,7 @@ void generate_best_row1(void) {
 	}
 
 	/* Sort the array.  */
-	qsort(fcs, 256, sizeof(fcs[0]), &factor_cost_compar);
+	qsort(fcs, 255, sizeof(fcs[0]), &factor_cost_compar);
 
 	/* Copy the first 128 entries.  */
 	for (i = 0; i < 128; ++i) {
@@ -371,14 +371,16 @@ Nevertheless, the generated sequence causes row 1 to be correct.
 }
 
 static
-void print_matrix(void) {
+void print_matrix(bool with_best_row1) {
 	unsigned int i, j;
 
-	printf("/* best_row1\n");
-	for (i = 0; i < 128; ++i) {
-		printf(" %02X(%2u)", best_row1[i], llr_xorgf_ones[best_row1[i]]);
+	if (with_best_row1) {
+		printf("/* best_row1\n");
+		for (i = 0; i < 128; ++i) {
+			printf(" %02X(%2u)", best_row1[i], llr_xorgf_ones[best_row1[i]]);
+		}
+		printf("\n*/\n");
 	}
-	printf("\n*/\n");
 
 	printf("/* FACTOR(COST)\n");
 	for (j = 0; j < 128; ++j) {
@@ -404,7 +406,361 @@ void print_sequence(const char* name, uint8_t const* seq) {
 	printf("};\n");
 }
 
-int main(void) {
+/* Search mode.
+
+The default sequences favour encoding: row 1 is simply the
+cheapest factors in order, and the rows below it are
+whatever falls out.
+In search mode, we instead run simulated annealing over the
+first few x and y values, to minimize the cost of the
+layouts that people actually use: up to SEARCH_MAX_WIDTH
+blocks, with up to SEARCH_MAX_PARITY parity blocks.
+
+Scaling by c and d keeps row 0 and column 0 all 1s, so
+for given x and y:
+
+    C[i][j] = (x[i] + y[0]) * (x[0] + y[j]) /
+              ((x[i] + y[j]) * (x[0] + y[0]))
+
+For each (k, m) layout, we count:
+
+* the XORs to encode, i.e. the llr_xorgf_ones cost of the
+  top-left k * m corner of the matrix.
+* if m >= 2, the average XORs to decode one lost data block
+  when parity block 0 is also lost, so that parity block 1
+  has to be used.
+* if m >= 2, the average XORs to decode two lost data
+  blocks from parity blocks 0 and 1.
+
+Decoding from parity blocks 0 and 1 only depends on row 1.
+Writing u for row 1, losing data blocks a and b, and
+r = 1 / (u[a] + u[b]), the decoding matrix is:
+
+    lost a: u[b] * r for parity 0, r for parity 1,
+            (u[b] + u[s]) * r for surviving data block s
+    lost b: the same with a and b exchanged
+
+Each cost is taken relative to that of the default
+sequences, and the sum over all layouts is minimized, so
+that every layout counts the same.
+The search starts from the default sequences and keeps
+the best state seen, so it cannot do worse than them.
+*/
+
+#define SEARCH_MAX_WIDTH 24
+#define SEARCH_MAX_PARITY 6
+#define SEARCH_DEFAULT_ITERATIONS 200000
+
+struct search_state {
+	uint8_t x[SEARCH_MAX_WIDTH];
+	uint8_t y[SEARCH_MAX_PARITY];
+};
+
+struct search_costs {
+	/* Cost to encode each (k, m) layout.  */
+	unsigned int encode[SEARCH_MAX_WIDTH + 1][SEARCH_MAX_PARITY + 1];
+	/* Average cost to decode one or two lost data blocks,
+	 * for each k.  */
+	double single[SEARCH_MAX_WIDTH + 1];
+	double dual[SEARCH_MAX_WIDTH + 1];
+};
+
+static
+uint8_t search_entry(struct search_state const* st,
+		     unsigned int i, unsigned int j) {
+	uint8_t num = gf_mul(st->x[i] ^ st->y[0], st->x[0] ^ st->y[j]);
+	uint8_t den = gf_mul(st->x[i] ^ st->y[j], st->x[0] ^ st->y[0]);
+	return gf_mul(num, gf_reciprocal(den));
+}
+
+static
+void search_evaluate(struct search_state const* st,
+		     struct search_costs* costs) {
+	uint8_t m[SEARCH_MAX_WIDTH][SEARCH_MAX_PARITY];
+	uint8_t const* u;
+	uint8_t row1[SEARCH_MAX_WIDTH];
+	/* Costs bucketed by the highest data block index
+	 * involved, so that each k is a prefix sum.  */
+	double single_bucket[SEARCH_MAX_WIDTH];
+	double dual_bucket[SEARCH_MAX_WIDTH];
+	double single_sum, dual_sum;
+	unsigned int i, j, k, a, b, t;
+
+	for (i = 0; i < SEARCH_MAX_WIDTH; ++i)
+		for (j = 0; j < SEARCH_MAX_PARITY; ++j)
+			m[i][j] = search_entry(st, i, j);
+
+	/* Encoding.  */
+	for (k = 0; k <= SEARCH_MAX_WIDTH; ++k)
+		for (j = 0; j <= SEARCH_MAX_PARITY; ++j)
+			costs->encode[k][j] = 0;
+	for (k = 1; k <= SEARCH_MAX_WIDTH; ++k) {
+		for (j = 1; j <= SEARCH_MAX_PARITY; ++j) {
+			costs->encode[k][j] = costs->encode[k - 1][j] +
+					      costs->encode[k][j - 1] -
+					      costs->encode[k - 1][j - 1] +
+					      llr_xorgf_ones[m[k - 1][j - 1]];
+		}
+	}
+
+	for (i = 0; i < SEARCH_MAX_WIDTH; ++i) {
+		row1[i] = m[i][1];
+		single_bucket[i] = 0;
+		dual_bucket[i] = 0;
+	}
+	u = row1;
+
+	/* One lost data block a, from parity block 1.  */
+	for (a = 0; a < SEARCH_MAX_WIDTH; ++a) {
+		uint8_t r = gf_reciprocal(u[a]);
+		single_bucket[a] += llr_xorgf_ones[r];
+		for (t = 0; t < SEARCH_MAX_WIDTH; ++t) {
+			if (t == a)
+				continue;
+			single_bucket[t > a ? t : a] +=
+				llr_xorgf_ones[gf_mul(u[t], r)];
+		}
+	}
+
+	/* Two lost data blocks a < b, from parity blocks 0
+	 * and 1.  */
+	for (b = 1; b < SEARCH_MAX_WIDTH; ++b) {
+		for (a = 0; a < b; ++a) {
+			uint8_t r = gf_reciprocal(u[a] ^ u[b]);
+			dual_bucket[b] += llr_xorgf_ones[gf_mul(u[b], r)] +
+					  llr_xorgf_ones[gf_mul(u[a], r)] +
+					  2 * llr_xorgf_ones[r];
+			for (t = 0; t < SEARCH_MAX_WIDTH; ++t) {
+				if (t == a || t == b)
+					continue;
+				dual_bucket[t > b ? t : b] +=
+					llr_xorgf_ones[gf_mul(u[b] ^ u[t], r)] +
+					llr_xorgf_ones[gf_mul(u[a] ^ u[t], r)];
+			}
+		}
+	}
+
+	single_sum = 0;
+	dual_sum = 0;
+	costs->single[0] = 0;
+	costs->dual[0] = 0;
+	for (k = 1; k <= SEARCH_MAX_WIDTH; ++k) {
+		single_sum += single_bucket[k - 1];
+		dual_sum += dual_bucket[k - 1];
+		costs->single[k] = single_sum / k;
+		costs->dual[k] = k < 2 ? 0 : dual_sum / (k * (k - 1) / 2);
+	}
+}
+
+/* The total cost, relative to the baseline costs.  */
+static
+double search_total(struct search_costs const* costs,
+		    struct search_costs const* base) {
+	unsigned int k, m;
+	double total = 0;
+
+	for (m = 1; m <= SEARCH_MAX_PARITY; ++m) {
+		for (k = 1; k + m <= SEARCH_MAX_WIDTH; ++k) {
+			total += (double) costs->encode[k][m] /
+				 (double) base->encode[k][m];
+			if (m < 2)
+				continue;
+			total += costs->single[k] / base->single[k];
+			if (k >= 2)
+				total += costs->dual[k] / base->dual[k];
+		}
+	}
+	return total;
+}
+
+/* A deterministic random number generator (xorshift32),
+ * so that the search gives the same result every run.  */
+static
+uint32_t search_random(uint32_t* state) {
+	uint32_t v = *state;
+	v ^= v << 13;
+	v ^= v >> 17;
+	v ^= v << 5;
+	*state = v;
+	return v;
+}
+
+/* e^-v, without needing libm.  */
+static
+double search_exp_neg(double v) {
+	double r;
+	unsigned int i;
+	if (v > 30)
+		return 0;
+	r = 1 - v / 1024;
+	for (i = 0; i < 10; ++i)
+		r = r * r;
+	return r;
+}
+
+static
+uint8_t* search_slot(struct search_state* st, unsigned int slot) {
+	if (slot < SEARCH_MAX_WIDTH)
+		return &st->x[slot];
+	return &st->y[slot - SEARCH_MAX_WIDTH];
+}
+
+static
+void search_report(struct search_costs const* base,
+		   struct search_costs const* best) {
+	unsigned int k, m;
+
+	fprintf(stderr, "%-8s %18s %22s %22s\n", "layout",
+		"encode", "decode 1 + P0", "decode 2");
+	for (m = 1; m <= SEARCH_MAX_PARITY; ++m) {
+		for (k = 1; k + m <= SEARCH_MAX_WIDTH; ++k) {
+			fprintf(stderr, "%2u+%-5u %5u -> %5u %+4.0f%%",
+				k, m, base->encode[k][m], best->encode[k][m],
+				100.0 * best->encode[k][m] / base->encode[k][m] - 100.0);
+			if (m >= 2)
+				fprintf(stderr, " %6.1f -> %6.1f %+4.0f%%",
+					base->single[k], best->single[k],
+					100.0 * best->single[k] / base->single[k] - 100.0);
+			if (m >= 2 && k >= 2)
+				fprintf(stderr, " %6.1f -> %6.1f %+4.0f%%",
+					base->dual[k], best->dual[k],
+					100.0 * best->dual[k] / base->dual[k] - 100.0);
+			fprintf(stderr, "\n");
+		}
+	}
+}
+
+static
+void search(unsigned long iterations) {
+	struct search_state cur, best, next;
+	struct search_costs base_costs, costs;
+	double cur_total, best_total, base_total;
+	/* Temperatures are in the same relative units as the
+	 * total, where each layout contributes about 1.  */
+	double temp = 0.05;
+	double cooling;
+	uint32_t rng = 0x11d;
+	bool used[256];
+	unsigned int i, j, n;
+	unsigned long it;
+
+	/* Start from the default sequences.  */
+	for (i = 0; i < SEARCH_MAX_WIDTH; ++i)
+		cur.x[i] = x_seq[i];
+	for (j = 0; j < SEARCH_MAX_PARITY; ++j)
+		cur.y[j] = y_seq[j];
+	search_evaluate(&cur, &base_costs);
+	base_total = search_total(&base_costs, &base_costs);
+	cur_total = base_total;
+	best = cur;
+	best_total = cur_total;
+
+	/* Cool down to 1/1000 of the starting temperature.  */
+	cooling = search_exp_neg(6.9 / (double) iterations);
+
+	for (it = 0; it < iterations; ++it, temp *= cooling) {
+		unsigned int slot = search_random(&rng) %
+				    (SEARCH_MAX_WIDTH + SEARCH_MAX_PARITY);
+		uint8_t v = search_random(&rng) & 0xFF;
+		uint8_t* p;
+		double next_total;
+
+		/* Put v in the slot; if it is already in another
+		 * slot, exchange them, so all values stay
+		 * distinct.  */
+		next = cur;
+		p = search_slot(&next, slot);
+		if (*p == v)
+			continue;
+		for (n = 0; n < SEARCH_MAX_WIDTH + SEARCH_MAX_PARITY; ++n) {
+			if (*search_slot(&next, n) == v) {
+				*search_slot(&next, n) = *p;
+				break;
+			}
+		}
+		*p = v;
+
+		search_evaluate(&next, &costs);
+		next_total = search_total(&costs, &base_costs);
+		if (next_total < cur_total ||
+		    (double) (search_random(&rng) & 0xFFFFFF) / 0x1000000 <
+		    search_exp_neg((next_total - cur_total) / temp)) {
+			cur = next;
+			cur_total = next_total;
+			if (cur_total < best_total) {
+				best = cur;
+				best_total = cur_total;
+			}
+		}
+	}
+
+	search_evaluate(&best, &costs);
+	search_report(&base_costs, &costs);
+	fprintf(stderr, "total relative cost: %.2f -> %.2f (%+.1f%%)\n",
+		base_total, best_total,
+		100.0 * best_total / base_total - 100.0);
+
+	/* Fill in the rest of x and y, keeping the order of
+	 * the default sequences for the values left over.  */
+	for (n = 0; n < 256; ++n)
+		used[n] = false;
+	for (i = 0; i < SEARCH_MAX_WIDTH; ++i)
+		used[best.x[i]] = true;
+	for (j = 0; j < SEARCH_MAX_PARITY; ++j)
+		used[best.y[j]] = true;
+	{
+		uint8_t old_x[128], old_y[128];
+		unsigned int ix = SEARCH_MAX_WIDTH;
+		unsigned int iy = SEARCH_MAX_PARITY;
+		memcpy(old_x, x_seq, 128);
+		memcpy(old_y, y_seq, 128);
+		memcpy(x_seq, best.x, SEARCH_MAX_WIDTH);
+		memcpy(y_seq, best.y, SEARCH_MAX_PARITY);
+		for (n = 0; n < 128 && ix < 128; ++n) {
+			if (!used[old_x[n]]) {
+				used[old_x[n]] = true;
+				x_seq[ix++] = old_x[n];
+			}
+		}
+		for (n = 0; n < 128 && iy < 128; ++n) {
+			if (!used[old_y[n]]) {
+				used[old_y[n]] = true;
+				y_seq[iy++] = old_y[n];
+			}
+		}
+		for (n = 0; n < 256; ++n) {
+			if (used[n])
+				continue;
+			used[n] = true;
+			if (ix < 128)
+				x_seq[ix++] = n;
+			else
+				y_seq[iy++] = n;
+		}
+	}
+
+	/* Scale so that row 0 and column 0 are all 1s, as
+	 * seq_init does.  */
+	for (j = 0; j < 128; ++j)
+		d_seq[j] = x_seq[0] ^ y_seq[j];
+	for (i = 0; i < 128; ++i)
+		c_seq[i] = gf_mul(x_seq[i] ^ y_seq[0],
+				  gf_reciprocal(x_seq[0] ^ y_seq[0]));
+	for (i = 0; i < 128; ++i) {
+		for (j = 0; j < 128; ++j) {
+			matrix[i][j] = gf_mul(gf_mul(c_seq[i], d_seq[j]),
+					      gf_reciprocal(x_seq[i] ^ y_seq[j]));
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	bool search_mode = argc > 1 && strcmp(argv[1], "search") == 0;
+	unsigned long iterations = SEARCH_DEFAULT_ITERATIONS;
+
+	if (search_mode && argc > 2)
+		iterations = strtoul(argv[2], NULL, 10);
+
 	printf("/* This file was generated by llr_cauchy_seq_generator.  */\n");
 	print_license();
 
@@ -416,7 +772,9 @@ int main(void) {
 	fflush(stdout);
 
 	seq_init();
-	print_matrix();
+	if (search_mode)
+		search(iterations);
+	print_matrix(!search_mode);
 
 	print_sequence("llr_cauchy_seq_c", c_seq);
 	printf("\n");
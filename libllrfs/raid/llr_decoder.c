@@ -27,6 +27,7 @@ SOFTWARE.
 #include"llr_matrix_inverse.h"
 #include"llr_util.h"
 #include"llr_xorgf.h"
+#include"llr_xorgf_ones.h"
 
 static
 enum llr_decoder_type
@@ -51,6 +52,36 @@ get_decoder_type(unsigned int num_data_blocks,
 	return llr_decoder_type_multi;
 }
 
+/* The decoder only solves for the lost data blocks.
+
+Let L be the lost data blocks, S the surviving data blocks,
+and P the first `|L|` surviving parity blocks.
+Each parity block in P is the sum of its row of the Cauchy
+matrix C times all the data blocks, so:
+
+    C[P][L] * d[L] + C[P][S] * d[S] = p[P]
+
+Writing A = C[P][L], which is square and (being part of a
+Cauchy matrix) invertible, and B = C[P][S]:
+
+    d[L] = inv(A) * B * d[S] + inv(A) * p[P]
+
+So only the `|L| * |L|` matrix A needs to be inverted, and
+the decoding matrix is `[inv(A) * B | inv(A)]`, with one row
+per lost data block, and one column per remaining block.
+*/
+
+/* Sizes of the pieces of the scratch space, for k lost data
+ * blocks.  */
+static
+unsigned int inverse_scratch_size(unsigned int k) {
+	return llr_matrix_inverse_scratch_space_size(k);
+}
+static
+unsigned int a_matrix_size(unsigned int k) {
+	return k * k;
+}
+
 void llr_decoder_sizes(unsigned int* matrix_storage_size,
 		       unsigned int* scratch_space_size,
 
@@ -64,6 +95,7 @@ void llr_decoder_sizes(unsigned int* matrix_storage_size,
 						      num_lost_data_blocks,
 						      lost_parity_blocks,
 						      num_lost_parity_blocks);
+	unsigned int k = num_lost_data_blocks;
 
 	if (type != llr_decoder_type_multi) {
 		/* No need for extra storage in RAID1 or RAID5
@@ -73,8 +105,145 @@ void llr_decoder_sizes(unsigned int* matrix_storage_size,
 		return;
 	}
 
-	*matrix_storage_size = num_data_blocks * num_data_blocks;
-	*scratch_space_size = llr_matrix_inverse_scratch_space_size(num_data_blocks);
+	*matrix_storage_size = k * num_data_blocks;
+	*scratch_space_size = inverse_scratch_size(k) + a_matrix_size(k);
+}
+
+void llr_decoder_max_sizes(unsigned int* matrix_storage_size,
+			   unsigned int* scratch_space_size,
+			   unsigned int num_data_blocks) {
+	unsigned int k = num_data_blocks;
+	*matrix_storage_size = k * num_data_blocks;
+	*scratch_space_size = inverse_scratch_size(k) + a_matrix_size(k);
+}
+
+/* Fill in the rows of the decoding matrix for the lost data
+ * blocks, using the given parity blocks as P.
+ * Entry `[i + j * stride]` is the factor for column i;
+ * the surviving data blocks are the first columns, and
+ * `used_parity[t]` goes to column `w - k + parity_offsets[t]`,
+ * or `w - k + t` if parity_offsets is 0.
+ * Any other columns are set to 0.  */
+static
+void build_matrix(unsigned int num_data_blocks,
+		  unsigned int const* lost_data_blocks,
+		  unsigned int num_lost_data_blocks,
+		  unsigned char const* used_parity,
+		  unsigned char const* parity_offsets,
+		  unsigned int stride,
+		  unsigned char* matrix_storage,
+		  unsigned char* scratch_space) {
+	unsigned int w = num_data_blocks;
+	unsigned int k = num_lost_data_blocks;
+	unsigned char* inverse_scratch = scratch_space;
+	unsigned char* a = &scratch_space[inverse_scratch_size(k)];
+	unsigned int data_idx;
+	unsigned int i, j, t, l;
+
+	if (stride != w)
+		llr_memzero(matrix_storage, k * stride);
+
+	/* Build A = C[P][L], and invert it.  */
+	for (t = 0; t < k; ++t) {
+		for (j = 0; j < k; ++j)
+			a[j + t * k] = llr_cauchy(lost_data_blocks[j],
+						  used_parity[t]);
+	}
+	llr_matrix_inverse_compute(k, inverse_scratch, a);
+
+	/* The parity columns of the decoding matrix are inv(A).  */
+	for (j = 0; j < k; ++j) {
+		for (t = 0; t < k; ++t) {
+			unsigned int col = w - k +
+					   (parity_offsets ? parity_offsets[t] : t);
+			matrix_storage[col + j * stride] = a[t + j * k];
+		}
+	}
+
+	/* The surviving data columns are inv(A) * B.  */
+	i = 0;
+	l = 0;
+	for (data_idx = 0; data_idx < w; ++data_idx) {
+		/* Is this data index lost?  */
+		if ((l < num_lost_data_blocks) &&
+		    (lost_data_blocks[l] == data_idx)) {
+			++l;
+			continue;
+		}
+		/* The inversion is done, so reuse its scratch space
+		 * for this column of B.  */
+		for (t = 0; t < k; ++t)
+			inverse_scratch[t] = llr_cauchy(data_idx, used_parity[t]);
+		for (j = 0; j < k; ++j) {
+			unsigned char sum = 0;
+			for (t = 0; t < k; ++t) {
+				sum = llr_gf_add(sum, llr_gf_mul(
+					a[t + j * k],
+					inverse_scratch[t]
+				));
+			}
+			matrix_storage[i + j * stride] = sum;
+		}
+		++i;
+	}
+}
+
+/* List the surviving parity blocks, up to max of them.
+ * Returns the number listed.  */
+static
+unsigned int list_surviving_parity(unsigned char* surviving,
+				   unsigned int max,
+				   unsigned int const* lost_parity_blocks,
+				   unsigned int num_lost_parity_blocks) {
+	unsigned int parity_idx, t, l;
+
+	t = 0;
+	l = 0;
+	for (parity_idx = 0; t < max; ++parity_idx) {
+		/* Is this parity index lost?  */
+		if ((l < num_lost_parity_blocks) &&
+		    (lost_parity_blocks[l] == parity_idx)) {
+			++l;
+			continue;
+		}
+		surviving[t] = parity_idx;
+		++t;
+	}
+	return t;
+}
+
+/* Fill in the rows of the decoding matrix for the lost data
+ * blocks, and the decoder object, for the multi-parity
+ * case, using the first k surviving parity blocks.  */
+static
+void init_multi(llr_decoder* decoder,
+		unsigned int num_data_blocks,
+		unsigned int const* lost_data_blocks,
+		unsigned int num_lost_data_blocks,
+		unsigned int const* lost_parity_blocks,
+		unsigned int num_lost_parity_blocks,
+		unsigned char* matrix_storage,
+		unsigned char* scratch_space) {
+	unsigned int w = num_data_blocks;
+	unsigned int k = num_lost_data_blocks;
+	/* The parity blocks we use, P above.  */
+	unsigned char used_parity[LLR_DECODER_MAX_BLOCKS];
+
+	decoder->type = llr_decoder_type_multi;
+	decoder->num_remaining = w;
+	decoder->num_lost_data_blocks = k;
+	decoder->num_lost_parity_blocks = 0;
+	decoder->matrix = matrix_storage;
+
+	/* With no lost data blocks, the remaining blocks are
+	 * just the data blocks.  */
+	if (k == 0)
+		return;
+
+	list_surviving_parity(used_parity, k,
+			      lost_parity_blocks, num_lost_parity_blocks);
+	build_matrix(w, lost_data_blocks, k, used_parity, 0, w,
+		     matrix_storage, scratch_space);
 }
 
 void llr_decoder_init(llr_decoder* decoder,
@@ -86,137 +255,403 @@ void llr_decoder_init(llr_decoder* decoder,
 		      unsigned int num_lost_parity_blocks,
 		      unsigned char* matrix_storage,
 		      unsigned char* scratch_space) {
-	unsigned int const* orig_lost_data_blocks;
-	unsigned int orig_num_lost_data_blocks;
-
-	unsigned int w = num_data_blocks;
-	unsigned int data_idx, parity_idx;
-	unsigned int j;
-
 	decoder->type = get_decoder_type(num_data_blocks,
 					 num_lost_data_blocks,
 					 lost_parity_blocks,
 					 num_lost_parity_blocks);
+	decoder->num_lost_parity_blocks = 0;
 
 	/* For simple cases, exit early.  */
-	if (decoder->type == llr_decoder_type_raid1)
+	if (decoder->type == llr_decoder_type_raid1) {
+		decoder->num_remaining = 1;
+		decoder->num_lost_data_blocks = 1;
 		return;
+	}
 	if (decoder->type == llr_decoder_type_raid5) {
 		decoder->num_remaining = num_data_blocks;
+		decoder->num_lost_data_blocks = 1;
 		return;
 	}
 
-	/* Save some variables.  */
-	orig_lost_data_blocks = lost_data_blocks;
-	orig_num_lost_data_blocks = num_lost_data_blocks;
+	init_multi(decoder, num_data_blocks,
+		   lost_data_blocks, num_lost_data_blocks,
+		   lost_parity_blocks, num_lost_parity_blocks,
+		   matrix_storage, scratch_space);
+}
 
-	/* Generate a version of our encoding matrix with the lost
-	 * data and parity rows missing.
-	 * This is the matrix that will be inversed.
-	 */
-	llr_memzero(matrix_storage, w * w);
-	j = 0;
+/* A resilver decoder also rebuilds the lost parity blocks.
 
-	/* Initialize the top part of the matrix.  */
-	for (data_idx = 0; data_idx < w; ++data_idx) {
-		/* Is this data index lost?  */
-		if ((num_lost_data_blocks > 0) &&
-		    (lost_data_blocks[0] == data_idx)) {
-			/* Skip this row.  */
-			++lost_data_blocks;
-			--num_lost_data_blocks;
-			continue;
-		}
-		/* Set 1 for the data block.  */
-		matrix_storage[j + data_idx] = 1;
-		j += w;
-	}
-
-	/* Initialize the bottom part of the matrix.  */
-	for (parity_idx = 0; parity_idx < num_parity_blocks; ++parity_idx) {
-		/* Is tthis parity index lsot?  */
-		if ((num_lost_parity_blocks > 0) &&
-		    (lost_parity_blocks[0] == parity_idx)) {
-			/* Skip this row.  */
-			++lost_parity_blocks;
-			--num_lost_parity_blocks;
-			continue;
+A lost parity block q is its row of the Cauchy matrix
+times the data blocks:
+
+    p[q] = C[q][S] * d[S] + C[q][L] * d[L]
+
+Substituting the rows of the decoding matrix for d[L]
+gives a row over the same remaining blocks, so the lost
+parity blocks come out of the same pass as the lost data
+blocks.
+*/
+
+void llr_decoder_resilver_sizes(unsigned int* matrix_storage_size,
+				unsigned int* scratch_space_size,
+
+				unsigned int num_data_blocks,
+				unsigned int num_parity_blocks,
+				unsigned int const* lost_data_blocks,
+				unsigned int num_lost_data_blocks,
+				unsigned int const* lost_parity_blocks,
+				unsigned int num_lost_parity_blocks) {
+	unsigned int k = num_lost_data_blocks;
+
+	*matrix_storage_size = (k + num_lost_parity_blocks) * num_data_blocks;
+	*scratch_space_size = inverse_scratch_size(k) + a_matrix_size(k);
+}
+
+void llr_decoder_resilver_init(llr_decoder* decoder,
+			       unsigned int num_data_blocks,
+			       unsigned int num_parity_blocks,
+			       unsigned int const* lost_data_blocks,
+			       unsigned int num_lost_data_blocks,
+			       unsigned int const* lost_parity_blocks,
+			       unsigned int num_lost_parity_blocks,
+			       unsigned char* matrix_storage,
+			       unsigned char* scratch_space) {
+	unsigned int w = num_data_blocks;
+	unsigned int k = num_lost_data_blocks;
+	/* C[q][L] for the lost parity block q; the inversion
+	 * is done by the time we need this, so reuse its
+	 * scratch space.  */
+	unsigned char* lost_coefs = scratch_space;
+	unsigned int data_idx, q;
+	unsigned int i, j, l;
+
+	init_multi(decoder, num_data_blocks,
+		   lost_data_blocks, num_lost_data_blocks,
+		   lost_parity_blocks, num_lost_parity_blocks,
+		   matrix_storage, scratch_space);
+	decoder->num_lost_parity_blocks = num_lost_parity_blocks;
+
+	for (q = 0; q < num_lost_parity_blocks; ++q) {
+		unsigned int parity_idx = lost_parity_blocks[q];
+		unsigned char* row = &matrix_storage[(k + q) * w];
+
+		for (j = 0; j < k; ++j)
+			lost_coefs[j] = llr_cauchy(lost_data_blocks[j], parity_idx);
+
+		/* C[q][L] times the rows for the lost data.  */
+		for (i = 0; i < w; ++i) {
+			unsigned char sum = 0;
+			for (j = 0; j < k; ++j) {
+				sum = llr_gf_add(sum, llr_gf_mul(
+					lost_coefs[j],
+					matrix_storage[i + j * w]
+				));
+			}
+			row[i] = sum;
 		}
-		/* Generate the Cauchy matrix.  */
+
+		/* Plus C[q][S] on the surviving data columns.  */
+		i = 0;
+		l = 0;
 		for (data_idx = 0; data_idx < w; ++data_idx) {
-			matrix_storage[j + data_idx] = llr_cauchy(data_idx,
-								  parity_idx);
+			/* Is this data index lost?  */
+			if ((l < num_lost_data_blocks) &&
+			    (lost_data_blocks[l] == data_idx)) {
+				++l;
+				continue;
+			}
+			row[i] = llr_gf_add(row[i],
+					    llr_cauchy(data_idx, parity_idx));
+			++i;
 		}
-		j += w;
-		/* Do we have enough to recover?  */
-		if (j >= w * w)
-			break;
 	}
+}
 
-	/* Perform inverse.  */
-	llr_matrix_inverse_compute(w, scratch_space, matrix_storage);
+/* A weighted decoder tries several choices of P.
 
-	/* Recover saved variables.  */
-	lost_data_blocks = orig_lost_data_blocks;
-	num_lost_data_blocks = orig_num_lost_data_blocks;
+Different choices give different decoding matrices, and
+the cost of a decode is the sum, over every entry of the
+matrix, of the XORs its multiplier performs
+(`llr_xorgf_ones`), plus whatever the caller says it costs
+to read the parity blocks in P.
+Rather than shuffle the remaining blocks around for each
+choice, the matrix has a column for every surviving parity
+block, with the ones not in P left at 0, which the decode
+skips.
+*/
 
-	/* Copy the rows corresponding to the lost data.  */
-	for (j = 0; j < num_lost_data_blocks; ++j) {
-		unsigned lost = lost_data_blocks[j];
+/* The most choices of P we try; beyond that, we stop at
+ * the best of the first ones, in lexicographic order.  */
+#define WEIGHTED_MAX_CANDIDATES 64
 
-		/* Skip copying rows that are already in the
-		 * correct place.  */
-		if (j == lost)
-			continue;
+static
+unsigned int matrix_cost(unsigned char const* matrix, unsigned int size) {
+	unsigned int i;
+	unsigned int cost = 0;
+	for (i = 0; i < size; ++i)
+		cost += llr_xorgf_ones[matrix[i]];
+	return cost;
+}
+
+void llr_decoder_weighted_sizes(unsigned int* matrix_storage_size,
+				unsigned int* scratch_space_size,
+
+				unsigned int num_data_blocks,
+				unsigned int num_parity_blocks,
+				unsigned int const* lost_data_blocks,
+				unsigned int num_lost_data_blocks,
+				unsigned int const* lost_parity_blocks,
+				unsigned int num_lost_parity_blocks) {
+	unsigned int k = num_lost_data_blocks;
+	unsigned int num_remaining = num_data_blocks - k +
+				     num_parity_blocks - num_lost_parity_blocks;
 
-		llr_memcpy(&matrix_storage[j * w],
-			   &matrix_storage[lost * w],
-			   w);
+	if (num_data_blocks == 1) {
+		*matrix_storage_size = 0;
+		*scratch_space_size = 0;
+		return;
 	}
 
-	/* Fill in the decoder object.  */
-	decoder->num_remaining = w;
-	decoder->num_lost_data_blocks = orig_num_lost_data_blocks;
+	*matrix_storage_size = k * num_remaining;
+	/* Plus the surviving parity blocks, and the current
+	 * choice of P, the best one and its parity blocks.  */
+	*scratch_space_size = inverse_scratch_size(k) + a_matrix_size(k) +
+			      num_parity_blocks - num_lost_parity_blocks +
+			      3 * k;
+}
+
+void llr_decoder_weighted_init(llr_decoder* decoder,
+			       unsigned int num_data_blocks,
+			       unsigned int num_parity_blocks,
+			       unsigned int const* lost_data_blocks,
+			       unsigned int num_lost_data_blocks,
+			       unsigned int const* lost_parity_blocks,
+			       unsigned int num_lost_parity_blocks,
+			       unsigned int const* parity_costs,
+			       unsigned char* matrix_storage,
+			       unsigned char* scratch_space) {
+	unsigned int w = num_data_blocks;
+	unsigned int k = num_lost_data_blocks;
+	unsigned int num_surviving_parity = num_parity_blocks -
+					    num_lost_parity_blocks;
+	unsigned int num_remaining = w - k + num_surviving_parity;
+	/* build_matrix uses the start of the scratch space; the
+	 * rest holds these.  */
+	unsigned char* surviving = &scratch_space[inverse_scratch_size(k) +
+						  a_matrix_size(k)];
+	/* The current choice of P, as indices into surviving,
+	 * and the best one so far.  */
+	unsigned char* choice = &surviving[num_surviving_parity];
+	unsigned char* best = &choice[k];
+	unsigned int best_cost = ~0U;
+	unsigned char* used_parity = &best[k];
+	unsigned int num_candidates = 0;
+	int built_best = 0;
+	unsigned int t, u;
+
+	decoder->num_lost_parity_blocks = 0;
+	decoder->num_lost_data_blocks = k;
+
+	/* Mirroring has nothing to choose from.  */
+	if (w == 1) {
+		decoder->type = llr_decoder_type_raid1;
+		decoder->num_remaining = 1;
+		return;
+	}
+
+	list_surviving_parity(surviving, num_surviving_parity,
+			      lost_parity_blocks, num_lost_parity_blocks);
+
+	for (t = 0; t < k; ++t)
+		choice[t] = t;
+	for (;;) {
+		unsigned int cost = 0;
+
+		for (t = 0; t < k; ++t) {
+			used_parity[t] = surviving[choice[t]];
+			if (parity_costs)
+				cost += parity_costs[used_parity[t]];
+		}
+		build_matrix(w, lost_data_blocks, k, used_parity, choice,
+			     num_remaining, matrix_storage, scratch_space);
+		cost += matrix_cost(matrix_storage, k * num_remaining);
+		if (cost < best_cost) {
+			best_cost = cost;
+			for (t = 0; t < k; ++t)
+				best[t] = choice[t];
+			built_best = 1;
+		} else {
+			built_best = 0;
+		}
+
+		if (++num_candidates == WEIGHTED_MAX_CANDIDATES)
+			break;
+		/* Next combination, in lexicographic order.  */
+		for (t = k; t > 0; --t) {
+			if (choice[t - 1] != num_surviving_parity - k + t - 1)
+				break;
+		}
+		if (t == 0)
+			break;
+		++choice[t - 1];
+		for (u = t; u < k; ++u)
+			choice[u] = choice[u - 1] + 1;
+	}
+
+	/* A single lost data block, rebuilt from the XOR
+	 * parity block, is just RAID5.  */
+	if (k == 1 && surviving[best[0]] == 0) {
+		decoder->type = llr_decoder_type_raid5;
+		decoder->num_remaining = w;
+		return;
+	}
+
+	if (!built_best) {
+		for (t = 0; t < k; ++t)
+			used_parity[t] = surviving[best[t]];
+		build_matrix(w, lost_data_blocks, k, used_parity, best,
+			     num_remaining, matrix_storage, scratch_space);
+	}
+
+	decoder->type = llr_decoder_type_multi;
+	decoder->num_remaining = num_remaining;
 	decoder->matrix = matrix_storage;
 }
 
+/* Budget, in bytes, for the slices that the multi-parity
+ * decode keeps live at once: one slice of every lost block,
+ * plus the slice of the remaining block being applied.
+ * This only splits planes once more than 32 blocks are in
+ * play, so up to 16 lost blocks still decode whole planes
+ * per pass.  Smaller budgets were measured slower, 4 to 16
+ * lost blocks included: they split each block into runs
+ * too short for the hardware prefetcher to keep up with.
+ */
+#define DECODE_TILE_BUDGET (128 * 1024)
+
+/* Pick the largest slice size that keeps all the blocks
+ * within the budget.  */
+static
+unsigned int decode_tile_size(unsigned int num_blocks) {
+	unsigned int tile = LLR_XORGF_BLOCK_SIZE / 8;
+	while ((tile > LLR_XORGF_SLICE_SIZE) &&
+	       (num_blocks * 8 * tile > DECODE_TILE_BUDGET))
+		tile >>= 1;
+	return tile;
+}
+
 void llr_decoder_decode(llr_decoder const* decoder,
 			void* const* restrict lost_data_blocks,
 			void const* const* restrict remaining_blocks) {
+	unsigned int num_lost = decoder->num_lost_data_blocks +
+				decoder->num_lost_parity_blocks;
 	unsigned int i, j;
+	unsigned int tile, offset;
 
 	if (decoder->type == llr_decoder_type_raid1) {
 		/* Just memcpy the first block to the data block.  */
-		llr_memcpy(lost_data_blocks[0], remaining_blocks[0],
-			   LLR_XORGF_BLOCK_SIZE);
+		if (!remaining_blocks[0])
+			llr_memzero(lost_data_blocks[0], LLR_XORGF_BLOCK_SIZE);
+		else
+			llr_memcpy(lost_data_blocks[0], remaining_blocks[0],
+				   LLR_XORGF_BLOCK_SIZE);
 		return;
 	}
 	if (decoder->type == llr_decoder_type_raid5) {
-		/* Copy the first remaining block.  */
-		llr_memcpy(lost_data_blocks[0], remaining_blocks[0],
-			   LLR_XORGF_BLOCK_SIZE);
-		for (i = 1; i < decoder->num_remaining; ++i) {
-			llr_xorgf_acc_mul(lost_data_blocks[0],
-					  1,
-					  remaining_blocks[i]);
-		}
+		/* Sum all the remaining blocks.  */
+		llr_xorgf_xor_n(lost_data_blocks[0], remaining_blocks,
+				decoder->num_remaining);
 		return;
 	}
 
-	/* Otherwise multiply by the submatrix.  */
+	/* Otherwise multiply by the submatrix.
+	 *
+	 * Work on one slice of every block at a time, so that
+	 * the slices of all the lost blocks stay in cache while
+	 * we stream through the remaining blocks.  */
+	tile = decode_tile_size(num_lost + 1);
+	for (offset = 0; offset < LLR_XORGF_BLOCK_SIZE / 8; offset += tile) {
+		/* Initialize the lost slices to 0.  */
+		for (j = 0; j < num_lost; ++j)
+			llr_xorgf_zero_slice(lost_data_blocks[j], offset, tile);
 
-	/* Initialize the lost blocks to 0.  */
-	for (j = 0; j < decoder->num_lost_data_blocks; ++j)
-		llr_memzero(lost_data_blocks[j], LLR_XORGF_BLOCK_SIZE);
+		/* Accumulate into the lost slices.  */
+		for (i = 0; i < decoder->num_remaining; ++i) {
+			/* Blocks of 0s add nothing.  */
+			if (!remaining_blocks[i] ||
+			    llr_xorgf_is_zero_slice(remaining_blocks[i], offset, tile))
+				continue;
+			for (j = 0; j < num_lost; ++j) {
+				unsigned char m;
+				m = decoder->matrix[i + j * decoder->num_remaining];
+				/* Multiplying by 0 adds nothing.  */
+				if (m == 0)
+					continue;
+				llr_xorgf_acc_mul_slice(lost_data_blocks[j],
+							m,
+							remaining_blocks[i],
+							offset, tile);
+			}
+		}
+	}
+}
+
+void llr_decoder_decode_range(llr_decoder const* decoder,
+			      void* const* restrict lost_data_blocks,
+			      void const* const* restrict remaining_blocks,
+			      unsigned int offset, unsigned int nbytes) {
+	unsigned int num_lost = decoder->num_lost_data_blocks +
+				decoder->num_lost_parity_blocks;
+	unsigned int i, j;
+
+	if (decoder->type == llr_decoder_type_raid1) {
+		if (!remaining_blocks[0])
+			llr_memzero((unsigned char*) lost_data_blocks[0] + offset,
+				    nbytes);
+		else
+			llr_memcpy((unsigned char*) lost_data_blocks[0] + offset,
+				   (unsigned char const*) remaining_blocks[0] + offset,
+				   nbytes);
+		return;
+	}
 
-	/* Accumulate into the lost blocks.  */
+	/* The range is small, so there is no need to tile.  */
+	for (j = 0; j < num_lost; ++j)
+		llr_memzero((unsigned char*) lost_data_blocks[j] + offset, nbytes);
 	for (i = 0; i < decoder->num_remaining; ++i) {
-		for (j = 0; j < decoder->num_lost_data_blocks; ++j) {
+		if (!remaining_blocks[i])
+			continue;
+		if (decoder->type == llr_decoder_type_raid5) {
+			llr_xorgf_acc_mul_range(lost_data_blocks[0], 1,
+						remaining_blocks[i],
+						offset, nbytes);
+			continue;
+		}
+		for (j = 0; j < num_lost; ++j) {
 			unsigned char m;
 			m = decoder->matrix[i + j * decoder->num_remaining];
-			llr_xorgf_acc_mul(lost_data_blocks[j],
-					  m,
-					  remaining_blocks[i]);
+			if (m == 0)
+				continue;
+			llr_xorgf_acc_mul_range(lost_data_blocks[j], m,
+						remaining_blocks[i],
+						offset, nbytes);
 		}
 	}
 }
+
+int llr_decoder_uses_block(llr_decoder const* decoder,
+			   unsigned int remaining_idx) {
+	unsigned int num_lost = decoder->num_lost_data_blocks +
+				decoder->num_lost_parity_blocks;
+	unsigned int j;
+
+	if (decoder->type == llr_decoder_type_raid1)
+		return remaining_idx == 0;
+	if (decoder->type == llr_decoder_type_raid5)
+		return 1;
+	for (j = 0; j < num_lost; ++j) {
+		if (decoder->matrix[remaining_idx + j * decoder->num_remaining] != 0)
+			return 1;
+	}
+	return 0;
+}
@@ -32,6 +32,16 @@ The object is constructed with a specific setup, and can
 only recover the specified lost data blocks.
 */
 
+/** LLR_DECODER_MAX_BLOCKS
+ *
+ * @brief The maximum number of data blocks, and of parity
+ * blocks, in a stripe.
+ *
+ * @desc This matches the widest Cauchy matrix supported
+ * by `llr_cauchy_seq`.
+ */
+#define LLR_DECODER_MAX_BLOCKS 128
+
 /** typedef llr_decoder
  *
  * @brief A decoder to recover data blocks, from a stripe
@@ -59,8 +69,17 @@ struct llr_decoder_s {
 	unsigned int num_remaining;
 	/** The number of data blocks to recover.  */
 	unsigned int num_lost_data_blocks;
+	/** The number of parity blocks to recover after the
+	 * data blocks.
+	 * Only nonzero for decoders from
+	 * `llr_decoder_resilver_init`.  */
+	unsigned int num_lost_parity_blocks;
 
-	/** The matrix to use during recovery.  */
+	/** The matrix to use during recovery.
+	 * Entry `[i + j * num_remaining]` is the factor
+	 * for remaining block i when recovering lost block j,
+	 * counting the lost data blocks, then the lost parity
+	 * blocks.  */
 	unsigned char const* matrix;
 };
 
@@ -108,6 +127,25 @@ void llr_decoder_sizes(unsigned int* matrix_storage_size,
 		       unsigned int const* lost_parity_blocks,
 		       unsigned int num_lost_parity_blocks);
 
+/** llr_decoder_max_sizes
+ *
+ * @brief Return the largest sizes `llr_decoder_sizes` can
+ * return for any decoder with the given number of data
+ * blocks.
+ *
+ * @param matrix_storage_size - output, the largest size of
+ * the `matrix_storage` buffer, in bytes.
+ * @param scratch_space_size - output, the largest size of
+ * the `scratch_space` buffer, in bytes.
+ * @param num_data_blocks - input, the number of actual
+ * data blocks in each stripe.
+ *
+ * @desc Useful for reusing buffers across decoders.
+ */
+void llr_decoder_max_sizes(unsigned int* matrix_storage_size,
+			   unsigned int* scratch_space_size,
+			   unsigned int num_data_blocks);
+
 /** llr_decoder_init
  *
  * @brief Initialize a decoder object.
@@ -151,6 +189,111 @@ void llr_decoder_init(llr_decoder* decoder,
 		      unsigned char* matrix_storage,
 		      unsigned char* scratch_space);
 
+/** llr_decoder_resilver_sizes
+ *
+ * @brief Like `llr_decoder_sizes`, but for
+ * `llr_decoder_resilver_init`.
+ *
+ * @desc The parameters are as for `llr_decoder_sizes`,
+ * except that `num_lost_data_blocks` may be 0, as long as
+ * `num_lost_data_blocks + num_lost_parity_blocks >= 1`.
+ */
+void llr_decoder_resilver_sizes(unsigned int* matrix_storage_size,
+				unsigned int* scratch_space_size,
+
+				unsigned int num_data_blocks,
+				unsigned int num_parity_blocks,
+				unsigned int const* lost_data_blocks,
+				unsigned int num_lost_data_blocks,
+				unsigned int const* lost_parity_blocks,
+				unsigned int num_lost_parity_blocks);
+
+/** llr_decoder_resilver_init
+ *
+ * @brief Initialize a decoder object that recovers the
+ * lost parity blocks as well as the lost data blocks.
+ *
+ * @desc The parameters are as for `llr_decoder_init`,
+ * except that `num_lost_data_blocks` may be 0, as long as
+ * `num_lost_data_blocks + num_lost_parity_blocks >= 1`,
+ * and the buffer sizes must be from
+ * `llr_decoder_resilver_sizes`.
+ *
+ * `llr_decoder_decode` then writes the lost data blocks
+ * followed by the lost parity blocks, all in a single
+ * pass over the remaining blocks.
+ * This saves re-reading the data to run `llr_encode`
+ * after decoding, when rebuilding a replaced device.
+ */
+void llr_decoder_resilver_init(llr_decoder* decoder,
+			       unsigned int num_data_blocks,
+			       unsigned int num_parity_blocks,
+			       unsigned int const* lost_data_blocks,
+			       unsigned int num_lost_data_blocks,
+			       unsigned int const* lost_parity_blocks,
+			       unsigned int num_lost_parity_blocks,
+			       unsigned char* matrix_storage,
+			       unsigned char* scratch_space);
+
+/** llr_decoder_weighted_sizes
+ *
+ * @brief Like `llr_decoder_sizes`, but for
+ * `llr_decoder_weighted_init`.
+ *
+ * @desc The parameters are as for `llr_decoder_sizes`.
+ */
+void llr_decoder_weighted_sizes(unsigned int* matrix_storage_size,
+				unsigned int* scratch_space_size,
+
+				unsigned int num_data_blocks,
+				unsigned int num_parity_blocks,
+				unsigned int const* lost_data_blocks,
+				unsigned int num_lost_data_blocks,
+				unsigned int const* lost_parity_blocks,
+				unsigned int num_lost_parity_blocks);
+
+/** llr_decoder_weighted_init
+ *
+ * @brief Initialize a decoder object, choosing which of
+ * the surviving parity blocks to decode from so that
+ * decoding is as cheap as possible.
+ *
+ * @param parity_costs - input, optional, the extra cost
+ * of reading each parity block, indexed by parity block.
+ * For example, a busy device can be given a high cost.
+ * The units are the XOR counts of `llr_xorgf_ones`, where
+ * adding a block costs 8.
+ * May be NULL if all parity blocks are equally cheap to
+ * read.
+ *
+ * @desc The other parameters are as for
+ * `llr_decoder_init`, except that the buffer sizes must
+ * be from `llr_decoder_weighted_sizes`.
+ *
+ * `llr_decoder_init` always decodes from the first
+ * surviving parity blocks.
+ * When more parity blocks survive than there are lost data
+ * blocks, other choices can give a decoding matrix that
+ * needs far fewer XORs, which is paid back on every
+ * degraded read.
+ * This tries up to 64 choices, and keeps the one with the
+ * lowest total cost.
+ *
+ * The remaining blocks given to `llr_decoder_decode` are
+ * the same as for `llr_decoder_init`: all the surviving
+ * data blocks, then all the surviving parity blocks.
+ */
+void llr_decoder_weighted_init(llr_decoder* decoder,
+			       unsigned int num_data_blocks,
+			       unsigned int num_parity_blocks,
+			       unsigned int const* lost_data_blocks,
+			       unsigned int num_lost_data_blocks,
+			       unsigned int const* lost_parity_blocks,
+			       unsigned int num_lost_parity_blocks,
+			       unsigned int const* parity_costs,
+			       unsigned char* matrix_storage,
+			       unsigned char* scratch_space);
+
 /** llr_decoder_decode
  *
  * @brief Recover the missing data blocks by providing
@@ -162,6 +305,9 @@ void llr_decoder_init(llr_decoder* decoder,
  * Recovered data will be placed here.
  * Recovered data blocks will be ordered from lowest index to
  * highest.
+ * For decoders from `llr_decoder_resilver_init`, the
+ * recovered parity blocks follow, again from lowest index
+ * to highest.
  * @param remaining_blocks - input, an array of pointers to
  * buffers, each buffer being the remaining data and parity
  * blocks.
@@ -169,9 +315,53 @@ void llr_decoder_init(llr_decoder* decoder,
  * Data blocks will be ordered from lowest index to highest,
  * then parity blocks will be ordered from lowest index to
  * highest.
+ * An entry may be NULL, indicating that the block is all
+ * 0s (for example, trimmed or never written).
+ * Such blocks, and blocks that turn out to be all 0s, are
+ * left out of the sums.
  */
 void llr_decoder_decode(llr_decoder const* decoder,
 			void* const* restrict lost_data_blocks,
 			void const* const* restrict remaining_blocks);
 
+/** llr_decoder_uses_block
+ *
+ * @brief Return nonzero if decoding reads the given
+ * remaining block.
+ *
+ * @param decoder - input, the decoder.
+ * @param remaining_idx - input, the position of the block
+ * in the `remaining_blocks` of `llr_decoder_decode`.
+ *
+ * @desc Blocks that are not used may be passed as NULL,
+ * so that callers need not read them from their devices.
+ */
+int llr_decoder_uses_block(llr_decoder const* decoder,
+			   unsigned int remaining_idx);
+
+/** llr_decoder_decode_range
+ *
+ * @brief Like `llr_decoder_decode`, but only recover a
+ * range of bytes of each lost block.
+ *
+ * @param offset - input, the offset of the range within
+ * each block.
+ * Must be a multiple of LLR_XORGF_SLICE_SIZE.
+ * @param nbytes - input, the length of the range.
+ * Must be a multiple of LLR_XORGF_SLICE_SIZE, and
+ * `offset + nbytes <= LLR_XORGF_BLOCK_SIZE`.
+ *
+ * @desc The other parameters are as for
+ * `llr_decoder_decode`.
+ * Only the range of each lost block is written, and the
+ * remaining blocks are only read at the offsets within
+ * each plane that the range covers (see
+ * `llr_xorgf_acc_mul_range`), so small degraded reads do
+ * not pay for rebuilding whole blocks.
+ */
+void llr_decoder_decode_range(llr_decoder const* decoder,
+			      void* const* restrict lost_data_blocks,
+			      void const* const* restrict remaining_blocks,
+			      unsigned int offset, unsigned int nbytes);
+
 #endif /* !defined(RAID_LLR_DECODER_H_) */
@@ -0,0 +1,201 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"llr_decoder_cache.h"
+#include<stddef.h>
+
+/* The lost blocks, as bitmaps of indices.  */
+#define KEY_WORDS ((LLR_DECODER_MAX_BLOCKS + 63) / 64)
+
+struct llr_decoder_cache_entry_s {
+	/** The neighbors in the recency list.  */
+	llr_decoder_cache_entry* prev;
+	llr_decoder_cache_entry* next;
+
+	/** The key.  */
+	unsigned int num_data_blocks;
+	unsigned int num_parity_blocks;
+	uint64_t lost_data[KEY_WORDS];
+	uint64_t lost_parity[KEY_WORDS];
+
+	/** The cached decoder and its matrix.  */
+	llr_decoder decoder;
+	unsigned char* matrix_storage;
+};
+
+static
+unsigned int matrix_storage_size(unsigned int max_num_data_blocks) {
+	unsigned int matrix_size, scratch_size;
+	llr_decoder_max_sizes(&matrix_size, &scratch_size, max_num_data_blocks);
+	return matrix_size;
+}
+static
+unsigned int scratch_space_size(unsigned int max_num_data_blocks) {
+	unsigned int matrix_size, scratch_size;
+	llr_decoder_max_sizes(&matrix_size, &scratch_size, max_num_data_blocks);
+	return scratch_size;
+}
+
+unsigned int llr_decoder_cache_size(unsigned int num_entries,
+				    unsigned int max_num_data_blocks) {
+	return num_entries * (sizeof(llr_decoder_cache_entry) +
+			      matrix_storage_size(max_num_data_blocks)) +
+	       scratch_space_size(max_num_data_blocks);
+}
+
+void llr_decoder_cache_init(llr_decoder_cache* cache,
+			    unsigned int num_entries,
+			    unsigned int max_num_data_blocks,
+			    void* storage) {
+	llr_decoder_cache_entry* entries = (llr_decoder_cache_entry*) storage;
+	unsigned char* matrices = (unsigned char*) &entries[num_entries];
+	unsigned int i;
+
+	/* All entries start out in the free list.  */
+	for (i = 0; i < num_entries; ++i) {
+		entries[i].prev = NULL;
+		entries[i].next = (i + 1 < num_entries) ? &entries[i + 1] : NULL;
+		entries[i].matrix_storage =
+			&matrices[i * matrix_storage_size(max_num_data_blocks)];
+	}
+
+	cache->head = NULL;
+	cache->tail = NULL;
+	cache->free_entries = entries;
+	cache->scratch_space =
+		&matrices[num_entries * matrix_storage_size(max_num_data_blocks)];
+	cache->hits = 0;
+	cache->misses = 0;
+}
+
+static
+void make_bitmap(uint64_t* bitmap,
+		 unsigned int const* indices, unsigned int num_indices) {
+	unsigned int i;
+	for (i = 0; i < KEY_WORDS; ++i)
+		bitmap[i] = 0;
+	for (i = 0; i < num_indices; ++i)
+		bitmap[indices[i] / 64] |= ((uint64_t) 1) << (indices[i] % 64);
+}
+
+static
+int key_equal(llr_decoder_cache_entry const* entry,
+	      unsigned int num_data_blocks,
+	      unsigned int num_parity_blocks,
+	      uint64_t const* lost_data,
+	      uint64_t const* lost_parity) {
+	unsigned int i;
+	if (entry->num_data_blocks != num_data_blocks ||
+	    entry->num_parity_blocks != num_parity_blocks)
+		return 0;
+	for (i = 0; i < KEY_WORDS; ++i) {
+		if (entry->lost_data[i] != lost_data[i] ||
+		    entry->lost_parity[i] != lost_parity[i])
+			return 0;
+	}
+	return 1;
+}
+
+/* Remove an entry from the recency list.  */
+static
+void unlink_entry(llr_decoder_cache* cache, llr_decoder_cache_entry* entry) {
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		cache->head = entry->next;
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		cache->tail = entry->prev;
+}
+
+/* Put an entry at the front of the recency list.  */
+static
+void push_front(llr_decoder_cache* cache, llr_decoder_cache_entry* entry) {
+	entry->prev = NULL;
+	entry->next = cache->head;
+	if (cache->head)
+		cache->head->prev = entry;
+	else
+		cache->tail = entry;
+	cache->head = entry;
+}
+
+llr_decoder const* llr_decoder_cache_get(llr_decoder_cache* cache,
+					 unsigned int num_data_blocks,
+					 unsigned int num_parity_blocks,
+					 unsigned int const* lost_data_blocks,
+					 unsigned int num_lost_data_blocks,
+					 unsigned int const* lost_parity_blocks,
+					 unsigned int num_lost_parity_blocks) {
+	uint64_t lost_data[KEY_WORDS];
+	uint64_t lost_parity[KEY_WORDS];
+	llr_decoder_cache_entry* entry;
+	unsigned int i;
+
+	make_bitmap(lost_data, lost_data_blocks, num_lost_data_blocks);
+	make_bitmap(lost_parity, lost_parity_blocks, num_lost_parity_blocks);
+
+	/* Look for it.
+	 * Caches are expected to be small, so a linear search
+	 * from the most recently used entry is good enough.  */
+	for (entry = cache->head; entry; entry = entry->next) {
+		if (key_equal(entry, num_data_blocks, num_parity_blocks,
+			      lost_data, lost_parity)) {
+			if (entry != cache->head) {
+				unlink_entry(cache, entry);
+				push_front(cache, entry);
+			}
+			++cache->hits;
+			return &entry->decoder;
+		}
+	}
+
+	/* Not found; take a free entry, or else replace the
+	 * least recently used one.  */
+	++cache->misses;
+	if (cache->free_entries) {
+		entry = cache->free_entries;
+		cache->free_entries = entry->next;
+	} else {
+		entry = cache->tail;
+		unlink_entry(cache, entry);
+	}
+
+	entry->num_data_blocks = num_data_blocks;
+	entry->num_parity_blocks = num_parity_blocks;
+	for (i = 0; i < KEY_WORDS; ++i) {
+		entry->lost_data[i] = lost_data[i];
+		entry->lost_parity[i] = lost_parity[i];
+	}
+	llr_decoder_init(&entry->decoder,
+			 num_data_blocks, num_parity_blocks,
+			 lost_data_blocks, num_lost_data_blocks,
+			 lost_parity_blocks, num_lost_parity_blocks,
+			 entry->matrix_storage,
+			 cache->scratch_space);
+
+	push_front(cache, entry);
+	return &entry->decoder;
+}
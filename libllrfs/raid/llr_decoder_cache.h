@@ -0,0 +1,162 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#if !defined(RAID_LLR_DECODER_CACHE_H_)
+#define RAID_LLR_DECODER_CACHE_H_
+#include"llr_decoder.h"
+#include<stdint.h>
+
+/*
+This module provides a cache of decoder objects, keyed by
+the pattern of lost blocks.
+
+Initializing a multi-parity decoder requires inverting a
+matrix, which is far more expensive than decoding a single
+stripe.
+In a degraded array, the same few patterns of lost blocks
+repeat for every stripe, so the cache lets those stripes
+reuse decoders that were already initialized.
+
+The cache holds a fixed number of decoders in memory
+provided by the caller.
+When full, the least recently used decoder is replaced.
+
+The cache is not thread-safe; use one cache per thread, or
+lock around `llr_decoder_cache_get` and the use of the
+returned decoder.
+*/
+
+/** typedef llr_decoder_cache
+ *
+ * @brief A bounded cache of initialized decoders.
+ */
+struct llr_decoder_cache_s;
+typedef struct llr_decoder_cache_s llr_decoder_cache;
+
+/** typedef llr_decoder_cache_entry
+ *
+ * @brief An entry in the cache.
+ * Internal to the cache.
+ */
+struct llr_decoder_cache_entry_s;
+typedef struct llr_decoder_cache_entry_s llr_decoder_cache_entry;
+
+struct llr_decoder_cache_s {
+	/** The entries, most recently used first.  */
+	llr_decoder_cache_entry* head;
+	/** The least recently used entry.  */
+	llr_decoder_cache_entry* tail;
+	/** Entries that have never been used.  */
+	llr_decoder_cache_entry* free_entries;
+
+	/** Space used while initializing decoders.  */
+	unsigned char* scratch_space;
+
+	/** The number of lookups that found a decoder.  */
+	unsigned long long hits;
+	/** The number of lookups that had to initialize
+	 * a decoder.  */
+	unsigned long long misses;
+};
+
+/** llr_decoder_cache_size
+ *
+ * @brief Return the size of the memory needed by the
+ * cache.
+ *
+ * @param num_entries - input, the number of decoders to
+ * keep.
+ * `num_entries != 0`
+ * @param max_num_data_blocks - input, the largest number
+ * of data blocks of any decoder that will be requested.
+ * `max_num_data_blocks <= LLR_DECODER_MAX_BLOCKS`
+ *
+ * @return the size of the buffer to pass to
+ * `llr_decoder_cache_init`, in bytes.
+ */
+unsigned int llr_decoder_cache_size(unsigned int num_entries,
+				    unsigned int max_num_data_blocks);
+
+/** llr_decoder_cache_init
+ *
+ * @brief Initialize an empty cache.
+ *
+ * @param cache - output, the cache to initialize.
+ * @param num_entries - input, the number of decoders to
+ * keep.
+ * `num_entries != 0`
+ * @param max_num_data_blocks - input, the largest number
+ * of data blocks of any decoder that will be requested.
+ * `max_num_data_blocks <= LLR_DECODER_MAX_BLOCKS`
+ * @param storage - input and retain, the memory for the
+ * cache.
+ * Its size must be from `llr_decoder_cache_size`, and it
+ * must be suitably aligned for any type, e.g. as returned
+ * by `malloc`.
+ * Do not free this until you finish with the cache.
+ */
+void llr_decoder_cache_init(llr_decoder_cache* cache,
+			    unsigned int num_entries,
+			    unsigned int max_num_data_blocks,
+			    void* storage);
+
+/** llr_decoder_cache_get
+ *
+ * @brief Return a decoder for the given pattern of lost
+ * blocks, initializing one if it is not in the cache.
+ *
+ * @param cache - input/output, the cache.
+ * @param num_data_blocks - input, the number of actual
+ * data blocks.
+ * `num_data_blocks <= max_num_data_blocks`
+ * @param num_parity_blocks - input, the number of actual
+ * parity blocks.
+ * `1 <= num_parity_blocks <= LLR_DECODER_MAX_BLOCKS`
+ * @param lost_data_blocks - input, the 0-based indices of
+ * the lost data blocks.
+ * Must be in sorted order.
+ * @param num_lost_data_blocks - input, the number of lost
+ * data blocks.
+ * `1 <= num_lost_data_blocks <= num_data_blocks`
+ * @param lost_parity_blocks - input, the 0-based indices
+ * of the lost parity blocks.
+ * Must be in sorted order.
+ * @param num_lost_parity_blocks - input, the number of
+ * lost parity blocks.
+ * `0 <= num_lost_parity_blocks <= num_parity_blocks`
+ *
+ * @return the decoder, which remains valid until the next
+ * call to `llr_decoder_cache_get` on the same cache.
+ *
+ * @desc The arguments have the same meaning as for
+ * `llr_decoder_init`, but the index arrays need not be
+ * retained after this call.
+ */
+llr_decoder const* llr_decoder_cache_get(llr_decoder_cache* cache,
+					 unsigned int num_data_blocks,
+					 unsigned int num_parity_blocks,
+					 unsigned int const* lost_data_blocks,
+					 unsigned int num_lost_data_blocks,
+					 unsigned int const* lost_parity_blocks,
+					 unsigned int num_lost_parity_blocks);
+
+#endif /* !defined(RAID_LLR_DECODER_CACHE_H_) */
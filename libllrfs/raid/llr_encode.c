@@ -31,6 +31,10 @@ void llr_encode(void const* const* data_blocks,
 		unsigned int num_data_blocks,
 		void* const* parity_blocks,
 		unsigned int num_parity_blocks) {
+	/* Nonzero data blocks not yet added to parity block 0.  */
+	void const* batch[LLR_XORGF_XOR_MAX];
+	unsigned int count = 0;
+	int acc = 0;
 	unsigned int i, j;
 
 	if (num_parity_blocks == 0)
@@ -45,32 +49,229 @@ void llr_encode(void const* const* data_blocks,
 		return;
 	}
 
-	/* Initialize the parity blocks from the first data block.  */
+	/* Initialize the other parity blocks from the first
+	 * data block.  */
 	/* assert(llr_cauchy(0, j) == 1); */
 	if (!data_blocks[0]) {
-		for (j = 0; j < num_parity_blocks; ++j) {
+		for (j = 1; j < num_parity_blocks; ++j) {
 			llr_memzero(parity_blocks[j], LLR_XORGF_BLOCK_SIZE);
 		}
 	} else {
-		for (j = 0; j < num_parity_blocks; ++j) {
+		for (j = 1; j < num_parity_blocks; ++j) {
 			llr_memcpy(parity_blocks[j], data_blocks[0], LLR_XORGF_BLOCK_SIZE);
 		}
 	}
 
-	for (i = 1; i < num_data_blocks; ++i) {
+	for (i = 0; i < num_data_blocks; ++i) {
 		/* Skip data blocks that are all-0s/nonexistent.  */
-		if (!data_blocks[i])
+		if (!data_blocks[i] || llr_xorgf_is_zero(data_blocks[i]))
 			continue;
 
-		/* Parity block 0 is just RAID5.  */
+		/* Parity block 0 is just RAID5, so sum the data
+		 * blocks a batch at a time.  */
 		/* assert(llr_cauchy(i, 0) == 1); */
-		llr_xorgf_acc_mul(parity_blocks[0], 1, data_blocks[i]);
+		batch[count++] = data_blocks[i];
+		if (count == LLR_XORGF_XOR_MAX) {
+			llr_xorgf_xor_batch(parity_blocks[0], batch, count, acc);
+			acc = 1;
+			count = 0;
+		}
 
+		/* The first data block was copied in above.  */
+		if (i == 0)
+			continue;
 		for (j = 1; j < num_parity_blocks; ++j) {
 			unsigned char factor = llr_cauchy(i, j);
 			llr_xorgf_acc_mul(parity_blocks[j], factor, data_blocks[i]);
 		}
 	}
+	if (count != 0)
+		llr_xorgf_xor_batch(parity_blocks[0], batch, count, acc);
+	else if (!acc)
+		llr_memzero(parity_blocks[0], LLR_XORGF_BLOCK_SIZE);
+}
+
+/* Budget, in bytes, for the slices that llr_encode_fused
+ * keeps live at once: one slice of every parity block,
+ * plus the slice of the data block being applied.
+ * Sized for a typical 32KiB L1 data cache.
+ */
+#define FUSED_TILE_BUDGET (32 * 1024)
+
+/* The number of factors llr_encode_fused caches on the
+ * stack, instead of recomputing them for every slice.
+ * Kept small since we may run on a tiny kernel stack.
+ */
+#define FUSED_MAX_CACHED_FACTORS 256
+
+/* Pick the largest slice size that keeps all the blocks
+ * within the budget.  */
+static
+unsigned int fused_tile_size(unsigned int num_blocks) {
+	unsigned int tile = LLR_XORGF_BLOCK_SIZE / 8;
+	while ((tile > LLR_XORGF_SLICE_SIZE) &&
+	       (num_blocks * 8 * tile > FUSED_TILE_BUDGET))
+		tile >>= 1;
+	return tile;
+}
+
+void llr_encode_fused(void const* const* data_blocks,
+		      unsigned int num_data_blocks,
+		      void* const* parity_blocks,
+		      unsigned int num_parity_blocks) {
+	unsigned int i, j;
+	unsigned int tile, offset;
+	unsigned char factors[FUSED_MAX_CACHED_FACTORS];
+	int cached;
+
+	if (num_parity_blocks == 0)
+		/* Nothing to do...?  */
+		return;
+
+	if (num_data_blocks == 0) {
+		/* No parity...  */
+		for (j = 0; j < num_parity_blocks; ++j) {
+			llr_memzero(parity_blocks[j], LLR_XORGF_BLOCK_SIZE);
+		}
+		return;
+	}
+
+	tile = fused_tile_size(num_parity_blocks + 1);
+
+	/* Parity block 0 and data block 0 are all 1s, so
+	 * only cache the rest of the matrix.  */
+	cached = (num_data_blocks - 1) * (num_parity_blocks - 1) <=
+		 FUSED_MAX_CACHED_FACTORS;
+	if (cached) {
+		for (i = 1; i < num_data_blocks; ++i) {
+			for (j = 1; j < num_parity_blocks; ++j) {
+				factors[(i - 1) * (num_parity_blocks - 1) + (j - 1)] =
+					llr_cauchy(i, j);
+			}
+		}
+	}
+
+	for (offset = 0; offset < LLR_XORGF_BLOCK_SIZE / 8; offset += tile) {
+		/* Initialize the parity slices from the first data
+		 * block.  */
+		/* assert(llr_cauchy(0, j) == 1); */
+		for (j = 0; j < num_parity_blocks; ++j) {
+			if (!data_blocks[0])
+				llr_xorgf_zero_slice(parity_blocks[j], offset, tile);
+			else
+				llr_xorgf_copy_slice(parity_blocks[j], data_blocks[0],
+						     offset, tile);
+		}
+
+		/* Apply the rest of the matrix to this slice.  */
+		for (i = 1; i < num_data_blocks; ++i) {
+			/* Skip data blocks that are all-0s/nonexistent.  */
+			if (!data_blocks[i] ||
+			    llr_xorgf_is_zero_slice(data_blocks[i], offset, tile))
+				continue;
+
+			/* Parity block 0 is just RAID5.  */
+			/* assert(llr_cauchy(i, 0) == 1); */
+			llr_xorgf_acc_mul_slice(parity_blocks[0], 1,
+						data_blocks[i],
+						offset, tile);
+
+			for (j = 1; j < num_parity_blocks; ++j) {
+				unsigned char factor;
+				if (cached)
+					factor = factors[(i - 1) * (num_parity_blocks - 1) + (j - 1)];
+				else
+					factor = llr_cauchy(i, j);
+				llr_xorgf_acc_mul_slice(parity_blocks[j], factor,
+							data_blocks[i],
+							offset, tile);
+			}
+		}
+	}
+}
+
+unsigned int llr_encode_plan_size(unsigned int num_data_blocks,
+				  unsigned int num_parity_blocks) {
+	unsigned int n = num_data_blocks * num_parity_blocks;
+	/* The kernels first, so they stay aligned.  */
+	return n * sizeof(llr_xorgf_kernel) + n;
+}
+
+void llr_encode_plan_init(llr_encode_plan* plan,
+			  unsigned int num_data_blocks,
+			  unsigned int num_parity_blocks,
+			  void* storage) {
+	unsigned int n = num_data_blocks * num_parity_blocks;
+	llr_xorgf_kernel* kernels = (llr_xorgf_kernel*) storage;
+	unsigned char* factors = (unsigned char*) &kernels[n];
+	unsigned int i, j;
+
+	for (j = 0; j < num_parity_blocks; ++j) {
+		for (i = 0; i < num_data_blocks; ++i) {
+			unsigned char factor = llr_cauchy(i, j);
+			factors[i + j * num_data_blocks] = factor;
+			kernels[i + j * num_data_blocks] =
+				llr_xorgf_get_kernel(factor);
+		}
+	}
+
+	plan->num_data_blocks = num_data_blocks;
+	plan->num_parity_blocks = num_parity_blocks;
+	plan->isa = llr_xorgf_get_isa();
+	plan->kernel_style = llr_xorgf_get_kernels();
+	plan->factors = factors;
+	plan->kernels = kernels;
+}
+
+void llr_encode_plan_run(llr_encode_plan const* plan,
+			 void const* const* data_blocks,
+			 void* const* parity_blocks) {
+	unsigned int k = plan->num_data_blocks;
+	unsigned int m = plan->num_parity_blocks;
+	unsigned int tile = fused_tile_size(m + 1);
+	/* If the variant or kernel style changed under us, the
+	 * kernels are still correct, but not the ones we should
+	 * use.  */
+	int direct = plan->isa == llr_xorgf_get_isa() &&
+		     plan->kernel_style == llr_xorgf_get_kernels();
+	unsigned int i, j, offset;
+
+	for (offset = 0; offset < LLR_XORGF_BLOCK_SIZE / 8; offset += tile) {
+		/* Initialize the parity slices from the first data
+		 * block.  */
+		/* assert(llr_cauchy(0, j) == 1); */
+		for (j = 0; j < m; ++j) {
+			if (!data_blocks[0])
+				llr_xorgf_zero_slice(parity_blocks[j], offset, tile);
+			else
+				llr_xorgf_copy_slice(parity_blocks[j], data_blocks[0],
+						     offset, tile);
+		}
+
+		/* Apply the rest of the matrix to this slice.  */
+		for (i = 1; i < k; ++i) {
+			unsigned char const* data;
+			/* Skip data blocks that are all-0s/nonexistent.  */
+			if (!data_blocks[i] ||
+			    llr_xorgf_is_zero_slice(data_blocks[i], offset, tile))
+				continue;
+			data = (unsigned char const*) data_blocks[i] + offset;
+
+			for (j = 0; j < m; ++j) {
+				unsigned char* parity;
+				if (!direct) {
+					llr_xorgf_acc_mul_slice(parity_blocks[j],
+								plan->factors[i + j * k],
+								data_blocks[i],
+								offset, tile);
+					continue;
+				}
+				parity = (unsigned char*) parity_blocks[j] + offset;
+				plan->kernels[i + j * k](parity, data,
+							 tile / LLR_XORGF_SLICE_SIZE, 1);
+			}
+		}
+	}
 }
 
 void llr_encode_modify(void const* restrict delta_data_block,
@@ -92,3 +293,79 @@ void llr_encode_modify(void const* restrict delta_data_block,
 		llr_xorgf_acc_mul(parity_blocks[j], factor, delta_data_block);
 	}
 }
+
+void llr_encode_update(void const* restrict old_data_block,
+		       void const* restrict new_data_block,
+		       unsigned int data_idx,
+		       void* const* parity_blocks,
+		       unsigned int num_parity_blocks) {
+	unsigned int i = data_idx;
+	unsigned int j;
+
+	if (num_parity_blocks == 0)
+		/* Nothing to do...?  */
+		return;
+
+	/* Parity block 0 is just RAID5.  */
+	llr_xorgf_acc_mul_diff(parity_blocks[0], 1,
+			       new_data_block, old_data_block);
+
+	for (j = 1; j < num_parity_blocks; ++j) {
+		unsigned char factor = llr_cauchy(i, j);
+		llr_xorgf_acc_mul_diff(parity_blocks[j], factor,
+				       new_data_block, old_data_block);
+	}
+}
+
+void llr_encode_update_n(void const* const* old_data_blocks,
+			 void const* const* new_data_blocks,
+			 unsigned int const* data_idxs,
+			 unsigned int num_updates,
+			 void* const* parity_blocks,
+			 unsigned int num_parity_blocks) {
+	unsigned int u, j;
+	unsigned int tile, offset;
+	unsigned char factors[FUSED_MAX_CACHED_FACTORS];
+	int cached;
+
+	if (num_parity_blocks == 0 || num_updates == 0)
+		/* Nothing to do...?  */
+		return;
+
+	/* One slice of every parity block, plus the slices of
+	 * the old and new data block being applied.  */
+	tile = fused_tile_size(num_parity_blocks + 2);
+
+	cached = num_updates * (num_parity_blocks - 1) <=
+		 FUSED_MAX_CACHED_FACTORS;
+	if (cached) {
+		for (u = 0; u < num_updates; ++u) {
+			for (j = 1; j < num_parity_blocks; ++j) {
+				factors[u * (num_parity_blocks - 1) + (j - 1)] =
+					llr_cauchy(data_idxs[u], j);
+			}
+		}
+	}
+
+	for (offset = 0; offset < LLR_XORGF_BLOCK_SIZE / 8; offset += tile) {
+		for (u = 0; u < num_updates; ++u) {
+			/* Parity block 0 is just RAID5.  */
+			llr_xorgf_acc_mul_diff_slice(parity_blocks[0], 1,
+						     new_data_blocks[u],
+						     old_data_blocks[u],
+						     offset, tile);
+
+			for (j = 1; j < num_parity_blocks; ++j) {
+				unsigned char factor;
+				if (cached)
+					factor = factors[u * (num_parity_blocks - 1) + (j - 1)];
+				else
+					factor = llr_cauchy(data_idxs[u], j);
+				llr_xorgf_acc_mul_diff_slice(parity_blocks[j], factor,
+							     new_data_blocks[u],
+							     old_data_blocks[u],
+							     offset, tile);
+			}
+		}
+	}
+}
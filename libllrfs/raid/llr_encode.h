@@ -22,6 +22,7 @@ SOFTWARE.
 #pragma once
 #if !defined(RAID_LLR_ENCODE_H_)
 #define RAID_LLR_ENCODE_H_
+#include"llr_xorgf.h"
 
 /*
 This module performs encoding, i.e. computing the
@@ -29,6 +30,10 @@ parity blocks from the data blocks.
 It also provides a function to perform modification,
 i.e. given the difference between two data blocks,
 modify the parity block.
+
+For arrays whose layout never changes, an encode plan
+precomputes the factors and kernels once, so that each
+stripe only needs to apply them.
 */
 
 /** llr_encode
@@ -42,6 +47,9 @@ modify the parity block.
  * An entry in this array may be NULL, indicating
  * that we should treat the data block as being all
  * 0.
+ * Data blocks that are all 0s (for example, never
+ * written) are detected and skipped either way, so
+ * encoding sparse stripes is cheap.
  * @param num_data_blocks - The number of data blocks.
  * @param parity_blocks - An array of pointers to the
  * parity blocks.
@@ -58,6 +66,34 @@ void llr_encode(void const* const* data_blocks,
 		void* const* parity_blocks,
 		unsigned int num_parity_blocks);
 
+/** llr_encode_fused
+ *
+ * @brief Computes all parity blocks from the given
+ * data blocks, tiling the work so that it stays in
+ * cache.
+ *
+ * @desc This takes the same arguments and gives the
+ * same result as `llr_encode`.
+ *
+ * `llr_encode` multiplies each data block into each
+ * parity block in turn, so every parity block is read
+ * and written once per data block.
+ * This instead splits every block into slices (see
+ * `llr_xorgf_acc_mul_slice`) small enough that one
+ * slice of every parity block, plus one data slice,
+ * fit in L1, and applies the whole matrix to one slice
+ * at a time.
+ * Each data slice is thus loaded from memory once and
+ * each parity slice is written back once.
+ *
+ * This is mostly useful with many parity blocks, where
+ * the parity blocks together no longer fit in L1.
+ */
+void llr_encode_fused(void const* const* data_blocks,
+		      unsigned int num_data_blocks,
+		      void* const* parity_blocks,
+		      unsigned int num_parity_blocks);
+
 /** llr_encode_modify
  *
  * @brief Modifies the parity blocks, given the delta
@@ -83,4 +119,146 @@ void llr_encode_modify(void const* restrict delta_data_block,
 		       void* const* parity_blocks,
 		       unsigned int num_parity_blocks);
 
+/** llr_encode_update
+ *
+ * @brief Modifies the parity blocks, given the old and
+ * new versions of a data block.
+ *
+ * @param old_data_block - The old version of the data
+ * block.
+ * @param new_data_block - The new version of the data
+ * block.
+ * @param data_idx - The index of the data block being
+ * modified.
+ * @param parity_blocks - An array of pointers to the
+ * parity blocks.
+ * Parity blocks are of LLR_XORGF_BLOCK_SIZE bytes.
+ * All entries must be non-NULL.
+ * Parity blocks must have unique locations in memory,
+ * i.e. they cannot share storage with each other or
+ * with the data blocks.
+ * @param num_parity_blocks - The number of parity
+ * blocks.
+ *
+ * @desc The result is the same as `llr_encode_modify`
+ * with the XOR of the old and new data block, but the
+ * difference is computed on the fly, so no buffer is
+ * needed for it.
+ */
+void llr_encode_update(void const* restrict old_data_block,
+		       void const* restrict new_data_block,
+		       unsigned int data_idx,
+		       void* const* parity_blocks,
+		       unsigned int num_parity_blocks);
+
+/** llr_encode_update_n
+ *
+ * @brief Modifies the parity blocks for several data
+ * blocks of the same stripe at once.
+ *
+ * @param old_data_blocks - The old versions of the data
+ * blocks.
+ * @param new_data_blocks - The new versions of the data
+ * blocks.
+ * @param data_idxs - The index of each data block being
+ * modified.
+ * @param num_updates - The number of data blocks being
+ * modified.
+ * @param parity_blocks - An array of pointers to the
+ * parity blocks, with the same constraints as for
+ * `llr_encode_update`.
+ * @param num_parity_blocks - The number of parity
+ * blocks.
+ *
+ * @desc The result is the same as calling
+ * `llr_encode_update` for each data block in turn, but
+ * the work is tiled the same way as `llr_encode_fused`,
+ * so the parity blocks are only loaded from memory and
+ * written back once.
+ */
+void llr_encode_update_n(void const* const* old_data_blocks,
+			 void const* const* new_data_blocks,
+			 unsigned int const* data_idxs,
+			 unsigned int num_updates,
+			 void* const* parity_blocks,
+			 unsigned int num_parity_blocks);
+
+struct llr_encode_plan_s;
+typedef struct llr_encode_plan_s llr_encode_plan;
+
+struct llr_encode_plan_s {
+	/** The number of data and parity blocks.  */
+	unsigned int num_data_blocks;
+	unsigned int num_parity_blocks;
+
+	/** The variant and kernel style the kernels were
+	 * resolved for.  */
+	enum llr_xorgf_isa isa;
+	enum llr_xorgf_kernels kernel_style;
+
+	/** Entry `[i + j * num_data_blocks]` is the factor
+	 * for data block i in parity block j.  */
+	unsigned char const* factors;
+	/** The kernels for the factors, in the same
+	 * layout.  */
+	llr_xorgf_kernel const* kernels;
+};
+
+/** llr_encode_plan_size
+ *
+ * @brief Return the size of the storage needed by an
+ * encode plan, in bytes.
+ *
+ * @param num_data_blocks - input, the number of data
+ * blocks.
+ * @param num_parity_blocks - input, the number of parity
+ * blocks.
+ */
+unsigned int llr_encode_plan_size(unsigned int num_data_blocks,
+				  unsigned int num_parity_blocks);
+
+/** llr_encode_plan_init
+ *
+ * @brief Initialize an encode plan for a layout.
+ *
+ * @param plan - output, the plan to initialize.
+ * @param num_data_blocks - input, the number of data
+ * blocks.
+ * `num_data_blocks != 0`
+ * @param num_parity_blocks - input, the number of parity
+ * blocks.
+ * `num_parity_blocks != 0`
+ * @param storage - input and retain, a buffer of the size
+ * from `llr_encode_plan_size`, aligned at least as well as
+ * `malloc` would.
+ * Do not free this until you finish with the plan.
+ */
+void llr_encode_plan_init(llr_encode_plan* plan,
+			  unsigned int num_data_blocks,
+			  unsigned int num_parity_blocks,
+			  void* storage);
+
+/** llr_encode_plan_run
+ *
+ * @brief Computes all parity blocks from the given data
+ * blocks, using a plan.
+ *
+ * @param plan - input, the plan for this layout.
+ * @param data_blocks - input, the data blocks, as for
+ * `llr_encode`.
+ * @param parity_blocks - output, the parity blocks, as
+ * for `llr_encode`.
+ *
+ * @desc The result is the same as `llr_encode`, and the
+ * work is tiled as for `llr_encode_fused`, but the
+ * factors are not recomputed, and each one calls its
+ * kernel directly.
+ * If `llr_xorgf_set_isa` or `llr_xorgf_set_kernels` has
+ * been called since the plan was initialized, this still
+ * works, but goes through the usual dispatch.
+ */
+void llr_encode_plan_run(llr_encode_plan const* plan,
+			 void const* const* data_blocks,
+			 void* const* parity_blocks);
+
 #endif /* !defined(RAID_LLR_ENCODE_H_) */
@@ -0,0 +1,74 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"llr_encode.h"
+#include"llr_encoder.h"
+#include"llr_util.h"
+#include"llr_xorgf.h"
+
+/*
+The parity blocks are running sums: each added data block
+is multiplied into them exactly as `llr_encode_modify`
+would apply a delta against an all-0 block.
+*/
+
+static
+void clear_parity(llr_encoder* encoder) {
+	unsigned int j;
+	for (j = 0; j < encoder->num_parity_blocks; ++j)
+		llr_memzero(encoder->parity_blocks[j], LLR_XORGF_BLOCK_SIZE);
+}
+
+void llr_encoder_init(llr_encoder* encoder,
+		      void* const* parity_blocks,
+		      unsigned int num_parity_blocks) {
+	encoder->parity_blocks = parity_blocks;
+	encoder->num_parity_blocks = num_parity_blocks;
+	encoder->num_added = 0;
+}
+
+void llr_encoder_add(llr_encoder* encoder,
+		     void const* restrict data_block,
+		     unsigned int data_idx) {
+	/* Skip data blocks that are all-0s/nonexistent.  */
+	if (!data_block)
+		return;
+
+	/* Clear the parity blocks only once we have
+	 * something to put in them.  */
+	if (encoder->num_added == 0)
+		clear_parity(encoder);
+	++encoder->num_added;
+
+	llr_encode_modify(data_block, data_idx,
+			  encoder->parity_blocks,
+			  encoder->num_parity_blocks);
+}
+
+void llr_encoder_finish(llr_encoder* encoder) {
+	/* An empty stripe has all-0 parity.  */
+	if (encoder->num_added == 0)
+		clear_parity(encoder);
+	encoder->num_added = 0;
+}
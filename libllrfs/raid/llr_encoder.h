@@ -0,0 +1,102 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#if !defined(RAID_LLR_ENCODER_H_)
+#define RAID_LLR_ENCODER_H_
+
+/*
+This module provides an encoder object, which computes
+the parity blocks of a stripe from data blocks given one
+at a time, in any order.
+
+Only the parity blocks need to be kept in memory while
+the stripe is open; each data block can be released as
+soon as it has been added.
+*/
+
+struct llr_encoder_s;
+typedef struct llr_encoder_s llr_encoder;
+
+struct llr_encoder_s {
+	/** The parity blocks being accumulated.  */
+	void* const* parity_blocks;
+	/** The number of parity blocks.  */
+	unsigned int num_parity_blocks;
+	/** The number of data blocks added so far.  */
+	unsigned int num_added;
+};
+
+/** llr_encoder_init
+ *
+ * @brief Initialize an encoder object for a new stripe.
+ *
+ * @param encoder - output, the encoder object to
+ * initialize.
+ * @param parity_blocks - input and retain, an array of
+ * pointers to the parity blocks, as for `llr_encode`.
+ * Do not free this until you finish with the encoder.
+ * @param num_parity_blocks - input, the number of parity
+ * blocks.
+ *
+ * @desc The parity blocks are not touched until the
+ * first data block is added (or the encoder is finished),
+ * so their previous contents do not matter.
+ */
+void llr_encoder_init(llr_encoder* encoder,
+		      void* const* parity_blocks,
+		      unsigned int num_parity_blocks);
+
+/** llr_encoder_add
+ *
+ * @brief Add a data block to the stripe.
+ *
+ * @param encoder - input/output, the encoder object.
+ * @param data_block - input, the data block, of
+ * LLR_XORGF_BLOCK_SIZE bytes.
+ * It can be released once this returns.
+ * May be NULL for an all-0 block, which does nothing.
+ * @param data_idx - input, the index of the data block
+ * within the stripe.
+ *
+ * @desc Data blocks may be added in any order.
+ * Each index should be added at most once; adding the
+ * same block again cancels it out.
+ */
+void llr_encoder_add(llr_encoder* encoder,
+		     void const* restrict data_block,
+		     unsigned int data_idx);
+
+/** llr_encoder_finish
+ *
+ * @brief Close the stripe, completing the parity blocks.
+ *
+ * @param encoder - input/output, the encoder object.
+ *
+ * @desc Data blocks that were never added are treated as
+ * all 0s, so the parity blocks then hold the same result
+ * as `llr_encode` on the full stripe.
+ * The encoder can then be reinitialized for another
+ * stripe.
+ */
+void llr_encoder_finish(llr_encoder* encoder);
+
+#endif /* !defined(RAID_LLR_ENCODER_H_) */
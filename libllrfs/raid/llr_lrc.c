@@ -0,0 +1,419 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"llr_cauchy.h"
+#include"llr_decoder.h"
+#include"llr_gf.h"
+#include"llr_lrc.h"
+#include"llr_matrix_inverse.h"
+#include"llr_util.h"
+#include"llr_xorgf.h"
+
+/*
+Every block of the stripe is a linear combination of the
+data blocks: data block i is itself, local parity block g
+is the sum of the data blocks of group g, and global
+parity block j is the sum of `llr_cauchy(i, j + 1)` times
+data block i.
+
+The decoder builds, for each lost block, a row of factors
+over the remaining blocks, as in `llr_decoder_init`.
+
+First, each lost data block that its group can fix on
+its own gets the row "local parity plus the other data
+blocks of the group".
+
+The other lost data blocks, U, are unknowns in a system of
+equations, one per surviving parity block that involves
+them: each says the parity block is the sum of its
+factors times the data blocks.
+We pick |U| independent equations E, preferring local
+ones, and with A the factors of E on U:
+
+    d[U] = inv(A) * (p[E] + (factors of E on the other
+                             data blocks) * d[others])
+
+where the other data blocks are either remaining, or
+already have rows from the first step.
+
+Finally the lost parity blocks are re-encoded from the
+rows of the data blocks.
+*/
+
+/* The shape of the stripe and what is lost from it.  */
+struct lrc_loss {
+	unsigned int k;
+	unsigned int l;
+	unsigned int m;
+	unsigned int const* lost_data;
+	unsigned int num_lost_data;
+	unsigned int const* lost_local;
+	unsigned int num_lost_local;
+	unsigned int const* lost_global;
+	unsigned int num_lost_global;
+};
+
+unsigned int llr_lrc_group_start(unsigned int num_data_blocks,
+				 unsigned int num_groups,
+				 unsigned int group) {
+	return group * num_data_blocks / num_groups;
+}
+
+static
+unsigned int group_of(struct lrc_loss const* s, unsigned int data_idx) {
+	unsigned int g = data_idx * s->l / s->k;
+	while (llr_lrc_group_start(s->k, s->l, g + 1) <= data_idx)
+		++g;
+	while (llr_lrc_group_start(s->k, s->l, g) > data_idx)
+		--g;
+	return g;
+}
+
+/* Return the position of idx in the sorted list, or n if
+ * it is not there.  */
+static
+unsigned int find(unsigned int const* list, unsigned int n, unsigned int idx) {
+	unsigned int t;
+	for (t = 0; t < n && list[t] < idx; ++t)
+		;
+	return (t < n && list[t] == idx) ? t : n;
+}
+
+/* Return the number of entries of the sorted list below
+ * idx.  */
+static
+unsigned int count_below(unsigned int const* list, unsigned int n,
+			 unsigned int idx) {
+	unsigned int t;
+	for (t = 0; t < n && list[t] < idx; ++t)
+		;
+	return t;
+}
+
+static
+unsigned int num_remaining(struct lrc_loss const* s) {
+	return s->k + s->l + s->m -
+	       s->num_lost_data - s->num_lost_local - s->num_lost_global;
+}
+
+/* Positions among the remaining blocks.  */
+static
+unsigned int data_col(struct lrc_loss const* s, unsigned int i) {
+	return i - count_below(s->lost_data, s->num_lost_data, i);
+}
+static
+unsigned int local_col(struct lrc_loss const* s, unsigned int g) {
+	return (s->k - s->num_lost_data) +
+	       g - count_below(s->lost_local, s->num_lost_local, g);
+}
+static
+unsigned int global_col(struct lrc_loss const* s, unsigned int j) {
+	return (s->k - s->num_lost_data) + (s->l - s->num_lost_local) +
+	       j - count_below(s->lost_global, s->num_lost_global, j);
+}
+
+/* Whether lost data block t (an index into lost_data) can
+ * be rebuilt from its group alone.  */
+static
+int locally_repairable(struct lrc_loss const* s, unsigned int t) {
+	unsigned int g = group_of(s, s->lost_data[t]);
+	unsigned int start = llr_lrc_group_start(s->k, s->l, g);
+	unsigned int end = llr_lrc_group_start(s->k, s->l, g + 1);
+
+	if (find(s->lost_local, s->num_lost_local, g) != s->num_lost_local)
+		return 0;
+	return count_below(s->lost_data, s->num_lost_data, end) -
+	       count_below(s->lost_data, s->num_lost_data, start) == 1;
+}
+
+static
+unsigned int count_unresolved(struct lrc_loss const* s) {
+	unsigned int t, n = 0;
+	for (t = 0; t < s->num_lost_data; ++t) {
+		if (!locally_repairable(s, t))
+			++n;
+	}
+	return n;
+}
+
+/* Sizes of the pieces of the scratch space, for u
+ * unresolved data blocks and r remaining blocks.  */
+static
+unsigned int scratch_size(unsigned int u, unsigned int r) {
+	unsigned int inverse = u ? llr_matrix_inverse_scratch_space_size(u) : 0;
+	/* Chosen equations, basis, A, pivots, unknowns,
+	 * candidate, one row.  */
+	return u * sizeof(unsigned int) + 2 * u * u + 3 * u + inverse + r;
+}
+
+/* Add coef times data block i to a row over the remaining
+ * blocks; if it is lost, its own row must already be
+ * built.  */
+static
+void add_data(struct lrc_loss const* s, unsigned char const* matrix,
+	      unsigned char* row, unsigned int i, unsigned char coef) {
+	unsigned int w = num_remaining(s);
+	unsigned int t = find(s->lost_data, s->num_lost_data, i);
+	unsigned int c;
+
+	if (coef == 0)
+		return;
+	if (t == s->num_lost_data) {
+		row[data_col(s, i)] = llr_gf_add(row[data_col(s, i)], coef);
+		return;
+	}
+	for (c = 0; c < w; ++c)
+		row[c] = llr_gf_add(row[c], llr_gf_mul(coef, matrix[c + t * w]));
+}
+
+/* The factor of equation e on data block i: equations
+ * below l are local parity blocks, the rest global.  */
+static
+unsigned char equation_factor(struct lrc_loss const* s, unsigned int e,
+			      unsigned int i) {
+	if (e < s->l)
+		return group_of(s, i) == e;
+	return llr_cauchy(i, e - s->l + 1);
+}
+
+void llr_lrc_encode(void const* const* data_blocks,
+		    unsigned int num_data_blocks,
+		    unsigned int num_groups,
+		    void* const* local_parity_blocks,
+		    void* const* global_parity_blocks,
+		    unsigned int num_global_parity_blocks) {
+	unsigned int i, j, g;
+
+	for (g = 0; g < num_groups; ++g) {
+		unsigned int start = llr_lrc_group_start(num_data_blocks, num_groups, g);
+		unsigned int end = llr_lrc_group_start(num_data_blocks, num_groups, g + 1);
+		llr_xorgf_xor_n(local_parity_blocks[g], &data_blocks[start],
+				end - start);
+	}
+
+	for (j = 0; j < num_global_parity_blocks; ++j)
+		llr_memzero(global_parity_blocks[j], LLR_XORGF_BLOCK_SIZE);
+	for (i = 0; i < num_data_blocks && num_global_parity_blocks != 0; ++i) {
+		/* Skip data blocks that are all-0s/nonexistent.  */
+		if (!data_blocks[i] || llr_xorgf_is_zero(data_blocks[i]))
+			continue;
+		for (j = 0; j < num_global_parity_blocks; ++j)
+			llr_xorgf_acc_mul(global_parity_blocks[j],
+					  llr_cauchy(i, j + 1),
+					  data_blocks[i]);
+	}
+}
+
+void llr_lrc_decoder_sizes(unsigned int* matrix_storage_size,
+			   unsigned int* scratch_space_size,
+
+			   unsigned int num_data_blocks,
+			   unsigned int num_groups,
+			   unsigned int num_global_parity_blocks,
+			   unsigned int const* lost_data_blocks,
+			   unsigned int num_lost_data_blocks,
+			   unsigned int const* lost_local_blocks,
+			   unsigned int num_lost_local_blocks,
+			   unsigned int const* lost_global_blocks,
+			   unsigned int num_lost_global_blocks) {
+	struct lrc_loss s;
+	unsigned int w;
+
+	s.k = num_data_blocks;
+	s.l = num_groups;
+	s.m = num_global_parity_blocks;
+	s.lost_data = lost_data_blocks;
+	s.num_lost_data = num_lost_data_blocks;
+	s.lost_local = lost_local_blocks;
+	s.num_lost_local = num_lost_local_blocks;
+	s.lost_global = lost_global_blocks;
+	s.num_lost_global = num_lost_global_blocks;
+	w = num_remaining(&s);
+
+	*matrix_storage_size = (num_lost_data_blocks + num_lost_local_blocks +
+				num_lost_global_blocks) * w;
+	*scratch_space_size = scratch_size(count_unresolved(&s), w);
+}
+
+int llr_lrc_decoder_init(llr_decoder* decoder,
+			 unsigned int num_data_blocks,
+			 unsigned int num_groups,
+			 unsigned int num_global_parity_blocks,
+			 unsigned int const* lost_data_blocks,
+			 unsigned int num_lost_data_blocks,
+			 unsigned int const* lost_local_blocks,
+			 unsigned int num_lost_local_blocks,
+			 unsigned int const* lost_global_blocks,
+			 unsigned int num_lost_global_blocks,
+			 unsigned char* matrix_storage,
+			 unsigned char* scratch_space) {
+	struct lrc_loss s;
+	unsigned int w, u, t, q, e, i, c, r, nb;
+	unsigned int* chosen;
+	unsigned char* basis;
+	unsigned char* a;
+	unsigned char* pivots;
+	unsigned char* unknowns;
+	unsigned char* v;
+	unsigned char* inverse_scratch;
+	unsigned char* tmp;
+
+	s.k = num_data_blocks;
+	s.l = num_groups;
+	s.m = num_global_parity_blocks;
+	s.lost_data = lost_data_blocks;
+	s.num_lost_data = num_lost_data_blocks;
+	s.lost_local = lost_local_blocks;
+	s.num_lost_local = num_lost_local_blocks;
+	s.lost_global = lost_global_blocks;
+	s.num_lost_global = num_lost_global_blocks;
+	w = num_remaining(&s);
+	u = count_unresolved(&s);
+
+	chosen = (unsigned int*) scratch_space;
+	basis = scratch_space + u * sizeof(unsigned int);
+	a = basis + u * u;
+	pivots = a + u * u;
+	unknowns = pivots + u;
+	v = unknowns + u;
+	inverse_scratch = v + u;
+	tmp = inverse_scratch + (u ? llr_matrix_inverse_scratch_space_size(u) : 0);
+
+	decoder->type = llr_decoder_type_multi;
+	decoder->num_remaining = w;
+	decoder->num_lost_data_blocks = num_lost_data_blocks;
+	decoder->num_lost_parity_blocks = num_lost_local_blocks +
+					  num_lost_global_blocks;
+	decoder->matrix = matrix_storage;
+
+	llr_memzero(matrix_storage,
+		    (num_lost_data_blocks + decoder->num_lost_parity_blocks) * w);
+
+	/* Local repairs.  */
+	u = 0;
+	for (t = 0; t < num_lost_data_blocks; ++t) {
+		unsigned int g = group_of(&s, lost_data_blocks[t]);
+		unsigned int end = llr_lrc_group_start(s.k, s.l, g + 1);
+		unsigned char* row = &matrix_storage[t * w];
+
+		if (!locally_repairable(&s, t)) {
+			unknowns[u++] = t;
+			continue;
+		}
+		row[local_col(&s, g)] = 1;
+		for (i = llr_lrc_group_start(s.k, s.l, g); i < end; ++i) {
+			if (i != lost_data_blocks[t])
+				row[data_col(&s, i)] = 1;
+		}
+	}
+
+	if (u != 0) {
+		/* Pick independent equations, keeping a reduced copy
+		 * of each in basis to test the next ones against.  */
+		nb = 0;
+		for (e = 0; e < s.l + s.m && nb < u; ++e) {
+			unsigned char* orig = &a[nb * u];
+			unsigned int p;
+
+			/* Skip lost parity blocks.  */
+			if (e < s.l) {
+				if (find(s.lost_local, s.num_lost_local, e) != s.num_lost_local)
+					continue;
+			} else {
+				if (find(s.lost_global, s.num_lost_global, e - s.l) != s.num_lost_global)
+					continue;
+			}
+
+			for (c = 0; c < u; ++c) {
+				orig[c] = equation_factor(&s, e, lost_data_blocks[unknowns[c]]);
+				v[c] = orig[c];
+			}
+			for (r = 0; r < nb; ++r) {
+				unsigned char f = v[pivots[r]];
+				if (f == 0)
+					continue;
+				for (c = 0; c < u; ++c)
+					v[c] = llr_gf_add(v[c], llr_gf_mul(f, basis[c + r * u]));
+			}
+			for (p = 0; p < u && v[p] == 0; ++p)
+				;
+			if (p == u)
+				/* Adds nothing new.  */
+				continue;
+			for (c = 0; c < u; ++c)
+				basis[c + nb * u] = llr_gf_mul(llr_gf_reciprocal(v[p]), v[c]);
+			pivots[nb] = p;
+			chosen[nb] = e;
+			++nb;
+		}
+		if (nb < u)
+			return 1;
+
+		llr_matrix_inverse_compute(u, inverse_scratch, a);
+
+		/* Each equation, as a row over the remaining blocks,
+		 * goes to each unknown with its factor in inv(A).  */
+		for (r = 0; r < u; ++r) {
+			e = chosen[r];
+			llr_memzero(tmp, w);
+			if (e < s.l)
+				tmp[local_col(&s, e)] = 1;
+			else
+				tmp[global_col(&s, e - s.l)] = 1;
+			for (i = 0; i < s.k; ++i) {
+				t = find(lost_data_blocks, num_lost_data_blocks, i);
+				if (t != num_lost_data_blocks && !locally_repairable(&s, t))
+					continue;
+				add_data(&s, matrix_storage, tmp, i,
+					 equation_factor(&s, e, i));
+			}
+			for (q = 0; q < u; ++q) {
+				unsigned char f = a[r + q * u];
+				unsigned char* row = &matrix_storage[unknowns[q] * w];
+				if (f == 0)
+					continue;
+				for (c = 0; c < w; ++c)
+					row[c] = llr_gf_add(row[c], llr_gf_mul(f, tmp[c]));
+			}
+		}
+	}
+
+	/* Re-encode the lost parity blocks.  */
+	for (q = 0; q < num_lost_local_blocks; ++q) {
+		unsigned int g = lost_local_blocks[q];
+		unsigned int end = llr_lrc_group_start(s.k, s.l, g + 1);
+		unsigned char* row = &matrix_storage[(num_lost_data_blocks + q) * w];
+		for (i = llr_lrc_group_start(s.k, s.l, g); i < end; ++i)
+			add_data(&s, matrix_storage, row, i, 1);
+	}
+	for (q = 0; q < num_lost_global_blocks; ++q) {
+		unsigned int j = lost_global_blocks[q];
+		unsigned char* row = &matrix_storage[(num_lost_data_blocks +
+						      num_lost_local_blocks + q) * w];
+		for (i = 0; i < s.k; ++i)
+			add_data(&s, matrix_storage, row, i, llr_cauchy(i, j + 1));
+	}
+
+	return 0;
+}
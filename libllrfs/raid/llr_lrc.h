@@ -0,0 +1,196 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#if !defined(RAID_LLR_LRC_H_)
+#define RAID_LLR_LRC_H_
+
+#include"llr_decoder.h"
+
+/*
+This module provides a Local Reconstruction Code (LRC)
+layout on top of the Cauchy parities of `llr_encode`.
+
+The data blocks of a stripe are split into groups of
+consecutive blocks, each with a local parity block that is
+the XOR of the group.
+Global parity blocks cover all the data blocks, using
+rows 1 onwards of the Cauchy matrix; row 0 would just be
+the sum of the local parity blocks.
+
+A single lost data block is then rebuilt from its group
+alone, reading about `num_data_blocks / num_groups` blocks
+instead of `num_data_blocks`.
+Patterns a group cannot fix by itself fall back to the
+global parity blocks, together with the local parity
+blocks of the affected groups.
+
+Group g covers the data blocks from
+`g * num_data_blocks / num_groups` up to (but not
+including) `(g + 1) * num_data_blocks / num_groups`, so
+group sizes differ by at most one.
+
+Lost blocks are described by their indices in three sorted
+lists: data blocks, local parity blocks, and global parity
+blocks.
+The remaining blocks are all the surviving blocks, in the
+order surviving data blocks, then surviving local parity
+blocks, then surviving global parity blocks.
+The decoders returned here use only some of the remaining
+blocks; see `llr_decoder_uses_block`.
+*/
+
+/** llr_lrc_group_start
+ *
+ * @brief Return the index of the first data block of a
+ * group.
+ *
+ * @param num_data_blocks - input, the number of data
+ * blocks in each stripe.
+ * @param num_groups - input, the number of groups.
+ * `1 <= num_groups <= num_data_blocks`
+ * @param group - input, the group, or `num_groups` to get
+ * one past the last data block.
+ */
+unsigned int llr_lrc_group_start(unsigned int num_data_blocks,
+				 unsigned int num_groups,
+				 unsigned int group);
+
+/** llr_lrc_encode
+ *
+ * @brief Computes the local and global parity blocks from
+ * the given data blocks.
+ *
+ * @param data_blocks - input, the data blocks, as for
+ * `llr_encode`.
+ * Entries may be NULL for all-0 blocks.
+ * @param num_data_blocks - input, the number of data
+ * blocks.
+ * `1 <= num_data_blocks <= LLR_DECODER_MAX_BLOCKS`
+ * @param num_groups - input, the number of groups, and of
+ * local parity blocks.
+ * `1 <= num_groups <= num_data_blocks`
+ * @param local_parity_blocks - output, the local parity
+ * blocks.
+ * @param global_parity_blocks - output, the global parity
+ * blocks.
+ * @param num_global_parity_blocks - input, the number of
+ * global parity blocks.
+ * `num_global_parity_blocks < LLR_DECODER_MAX_BLOCKS`
+ *
+ * @desc Parity blocks must not share storage with each
+ * other or with any data blocks.
+ */
+void llr_lrc_encode(void const* const* data_blocks,
+		    unsigned int num_data_blocks,
+		    unsigned int num_groups,
+		    void* const* local_parity_blocks,
+		    void* const* global_parity_blocks,
+		    unsigned int num_global_parity_blocks);
+
+/** llr_lrc_decoder_sizes
+ *
+ * @brief Return the sizes needed for the buffers of
+ * `llr_lrc_decoder_init`.
+ *
+ * @desc As for `llr_decoder_sizes`, the `matrix_storage`
+ * must be retained for the lifetime of the decoder, while
+ * the `scratch_space` is only used during initialization.
+ *
+ * The other parameters are as for `llr_lrc_decoder_init`.
+ */
+void llr_lrc_decoder_sizes(unsigned int* matrix_storage_size,
+			   unsigned int* scratch_space_size,
+
+			   unsigned int num_data_blocks,
+			   unsigned int num_groups,
+			   unsigned int num_global_parity_blocks,
+			   unsigned int const* lost_data_blocks,
+			   unsigned int num_lost_data_blocks,
+			   unsigned int const* lost_local_blocks,
+			   unsigned int num_lost_local_blocks,
+			   unsigned int const* lost_global_blocks,
+			   unsigned int num_lost_global_blocks);
+
+/** llr_lrc_decoder_init
+ *
+ * @brief Initialize a decoder object for an LRC stripe,
+ * repairing from the local groups where possible.
+ *
+ * @param decoder - output, the decoder object.
+ * @param num_data_blocks - input, the number of data
+ * blocks in each stripe.
+ * @param num_groups - input, the number of groups.
+ * @param num_global_parity_blocks - input, the number of
+ * global parity blocks.
+ * @param lost_data_blocks - input, the sorted indices of
+ * the lost data blocks.
+ * @param num_lost_data_blocks - input, the number of lost
+ * data blocks.
+ * @param lost_local_blocks - input, the sorted indices
+ * of the lost local parity blocks, i.e. their groups.
+ * @param num_lost_local_blocks - input, the number of
+ * lost local parity blocks.
+ * @param lost_global_blocks - input, the sorted indices
+ * of the lost global parity blocks.
+ * @param num_lost_global_blocks - input, the number of
+ * lost global parity blocks.
+ * At least one block, of any kind, must be lost.
+ * @param matrix_storage - input and retain, a buffer of
+ * the size from `llr_lrc_decoder_sizes`.
+ * @param scratch_space - input, a buffer of the size from
+ * `llr_lrc_decoder_sizes`.
+ *
+ * @return 0 on success, or nonzero if the lost blocks
+ * cannot be recovered.
+ *
+ * @desc Unlike plain Cauchy stripes, whether a pattern of
+ * losses can be recovered does not only depend on how
+ * many blocks are lost, so this can fail.
+ *
+ * A lost data block that is the only loss among the data
+ * blocks of its group, and whose local parity block
+ * survives, is rebuilt from its group alone.
+ * The others are solved together from the surviving local
+ * parity blocks of their groups and the surviving global
+ * parity blocks, preferring local parity blocks.
+ *
+ * `llr_decoder_decode` then writes the lost data blocks,
+ * then the lost local parity blocks, then the lost global
+ * parity blocks, each from lowest index to highest.
+ * It takes the remaining blocks as described above; those
+ * for which `llr_decoder_uses_block` returns 0 may be
+ * passed as NULL, and need not be read at all.
+ */
+int llr_lrc_decoder_init(llr_decoder* decoder,
+			 unsigned int num_data_blocks,
+			 unsigned int num_groups,
+			 unsigned int num_global_parity_blocks,
+			 unsigned int const* lost_data_blocks,
+			 unsigned int num_lost_data_blocks,
+			 unsigned int const* lost_local_blocks,
+			 unsigned int num_lost_local_blocks,
+			 unsigned int const* lost_global_blocks,
+			 unsigned int num_lost_global_blocks,
+			 unsigned char* matrix_storage,
+			 unsigned char* scratch_space);
+
+#endif /* !defined(RAID_LLR_LRC_H_) */
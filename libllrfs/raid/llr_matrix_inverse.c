@@ -40,16 +40,104 @@ mat_at(unsigned int w,
 	return &mat[i + j * w * 2];
 }
 
-/* Gaussian elimiation.  */
+/* Row operations.
+
+Each row operation multiplies a whole row by the same
+constant, so instead of doing llr_gf_mul (two log lookups, a
+branch and a pow lookup) per element, we first build product
+tables for that constant: one for the low nibble and one for
+the high nibble of the other operand.
+Since multiplication distributes over add (XOR),
+`c * x == lo[x & 0xF] ^ hi[x >> 4]`.
+*/
+/* Below this many columns, building the tables costs more
+ * than it saves, and we use llr_gf_mul directly.  */
+#define ROW_TABLE_MIN 24
+
+struct row_mul_table {
+	unsigned char lo[16];
+	unsigned char hi[16];
+};
+
+/* Built with llr_gf_mul, so the tables always agree with
+ * the field that llr_gf defines.  */
+static
+void row_mul_table_init(struct row_mul_table* t, unsigned char c) {
+	unsigned int n;
+
+	for (n = 0; n < 16; ++n) {
+		t->lo[n] = llr_gf_mul(c, (unsigned char) n);
+		t->hi[n] = llr_gf_mul(c, (unsigned char) (n << 4));
+	}
+}
+
+/* dst[i] = c * dst[i], for columns from..to-1.  */
+static
+void row_mul(unsigned char* dst, unsigned char c,
+	     unsigned int from, unsigned int to) {
+	struct row_mul_table t;
+	unsigned int i;
+
+	if (to - from < ROW_TABLE_MIN) {
+		for (i = from; i < to; ++i)
+			dst[i] = llr_gf_mul(c, dst[i]);
+		return;
+	}
+	row_mul_table_init(&t, c);
+	for (i = from; i < to; ++i)
+		dst[i] = t.lo[dst[i] & 0xF] ^ t.hi[dst[i] >> 4];
+}
+
+/* dst[i] -= c * src[i], for columns from..to-1.  */
+static
+void row_mul_sub(unsigned char* restrict dst, unsigned char const* restrict src,
+		 unsigned char c, unsigned int from, unsigned int to) {
+	struct row_mul_table t;
+	unsigned int i;
+
+	if (c == 1) {
+		for (i = from; i < to; ++i)
+			dst[i] ^= src[i];
+		return;
+	}
+	if (to - from < ROW_TABLE_MIN) {
+		for (i = from; i < to; ++i)
+			dst[i] ^= llr_gf_mul(c, src[i]);
+		return;
+	}
+	row_mul_table_init(&t, c);
+	for (i = from; i < to; ++i)
+		dst[i] ^= t.lo[src[i] & 0xF] ^ t.hi[src[i] >> 4];
+}
+
+/* Gaussian elimiation.
+
+Only a part of each row can be nonzero at any time, and
+the row operations only need to cover that part:
+
+- Left of the diagonal, the columns have already been
+  cleared in every row except the pivot row of that
+  column, and the current pivot row has a 0 there.
+- On the right half, which starts out as the identity
+  matrix, column `w + r` stays untouched (a single 1 in row
+  `r`) until row `r` is mixed into some other row.
+  We track the end of the columns that may have been
+  mixed, in `end`.
+*/
 void llr_matrix_inverse(unsigned int w,
 			unsigned char* scratch_space) {
 	unsigned char* mat = scratch_space;
 
-	unsigned int i, j, jj;
+	unsigned int j, jj;
+	unsigned int end = w;
 
 	/* Process each row.  */
 	for (j = 0; j < w; ++j) {
-		unsigned char e, one_over_e;
+		unsigned char e;
+
+		/* Row j gets mixed into every other row below.  */
+		if (end < w + j + 1)
+			end = w + j + 1;
 
 		/* Get the diagonal.  */
 		e = *mat_at(w, mat, j, j);
@@ -57,6 +145,7 @@ void llr_matrix_inverse(unsigned int w,
 		/* Is the diagonal 0?
 		 * Make it nonzero.  */
 		if (e == 0x00) {
+			unsigned int r;
 			/* Search for a row that has nonzero
 			 * that column.
 			 * Note the "w - j" --- we search from
@@ -78,13 +167,12 @@ void llr_matrix_inverse(unsigned int w,
 				if (*mat_at(w, mat, j, w - jj - 1) != 0)
 					break;
 			}
+			r = w - jj - 1;
+			if (end < w + r + 1)
+				end = w + r + 1;
 			/* Add that row to this row.  */
-			for (i = 0; i < w * 2; ++i) {
-				*mat_at(w, mat, i, j) = llr_gf_add(
-					*mat_at(w, mat, i, j),
-					*mat_at(w, mat, i, w - jj - 1)
-				);
-			}
+			row_mul_sub(mat_at(w, mat, 0, j), mat_at(w, mat, 0, r),
+				    1, 0, end);
 			/* The columns to the left of the diagonal
 			 * are now possibly non-zero.
 			 * Cancel them out.
@@ -96,15 +184,9 @@ void llr_matrix_inverse(unsigned int w,
 				/* Subtract the corresponding previous
 				 * row times e, which was already an
 				 * identity matrix.  */
-				for (i = 0; i < w * 2; ++i) {
-					*mat_at(w, mat, i, j) = llr_gf_sub(
-						*mat_at(w, mat, i, j),
-						llr_gf_mul(
-							e,
-							*mat_at(w, mat, i, jj)
-						)
-					);
-				}
+				row_mul_sub(mat_at(w, mat, 0, j),
+					    mat_at(w, mat, 0, jj),
+					    e, 0, end);
 			}
 
 			/* Re-sample the diagonal.  */
@@ -112,15 +194,9 @@ void llr_matrix_inverse(unsigned int w,
 		}
 
 		/* If not 1, divide the entire row.  */
-		if (e != 0x01) {
-			one_over_e = llr_gf_reciprocal(e);
-			for (i = 0; i < w * 2; ++i) {
-				*mat_at(w, mat, i, j) = llr_gf_mul(
-					one_over_e,
-					*mat_at(w, mat, i, j)
-				);
-			}
-		}
+		if (e != 0x01)
+			row_mul(mat_at(w, mat, 0, j), llr_gf_reciprocal(e),
+				j, end);
 
 		/* For every *other* row, make the entries
 		 * on the same column into 0.
@@ -131,19 +207,14 @@ void llr_matrix_inverse(unsigned int w,
 				continue;
 			mult = *mat_at(w, mat, j, jj);
 			/* If already 0, do nothing.  */
-			if (e == 0)
+			if (mult == 0)
 				continue;
 			/* Multiply the elements of this
 			 * row (j) by the mult, then
 			 * subtract from the row jj.
 			 */
-			for (i = 0; i < w * 2; ++i) {
-				*mat_at(w, mat, i, jj) = llr_gf_sub(
-					*mat_at(w, mat, i, jj),
-					llr_gf_mul(mult,
-						   *mat_at(w, mat, i, j))
-				);
-			}
+			row_mul_sub(mat_at(w, mat, 0, jj), mat_at(w, mat, 0, j),
+				    mult, j, end);
 		}
 	}
 }
@@ -0,0 +1,311 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"llr_cauchy.h"
+#include"llr_decoder.h"
+#include"llr_gf.h"
+#include"llr_util.h"
+#include"llr_verify.h"
+#include"llr_xorgf.h"
+
+#define PLANE_SIZE (LLR_XORGF_BLOCK_SIZE / 8)
+
+/* The most syndromes that fit in one scratch block: it
+ * holds one slice of each, side by side in every plane.  */
+#define MAX_ROWS (PLANE_SIZE / LLR_XORGF_SLICE_SIZE)
+
+/* The widest tile that lets num_rows syndromes share a
+ * scratch block.  */
+static
+unsigned int tile_size(unsigned int num_rows) {
+	unsigned int tile = PLANE_SIZE;
+	if (num_rows > MAX_ROWS)
+		num_rows = MAX_ROWS;
+	while (tile * num_rows > PLANE_SIZE)
+		tile >>= 1;
+	return tile;
+}
+
+/* Syndrome g lives in scratch block `g / MAX_ROWS`, at
+ * this offset within each plane.  */
+static inline
+unsigned char* row_block(unsigned char* syndromes, unsigned int g) {
+	return &syndromes[(g / MAX_ROWS) * LLR_XORGF_BLOCK_SIZE];
+}
+
+static inline
+unsigned int row_offset(unsigned int g, unsigned int tile) {
+	return (g % MAX_ROWS) * tile;
+}
+
+/* Byte o of syndrome g's slice in plane 0.  */
+static inline
+unsigned char const* row_byte(unsigned char* syndromes, unsigned int g,
+			      unsigned int tile, unsigned int o) {
+	return &row_block(syndromes, g)[row_offset(g, tile) + o];
+}
+
+/* Compute one tile of the syndromes for parity blocks
+ * first to first + num_rows - 1.  */
+static
+void build_syndromes(unsigned char* syndromes,
+		     void const* const* data_blocks,
+		     unsigned int num_data_blocks,
+		     void const* const* parity_blocks,
+		     unsigned int first, unsigned int num_rows,
+		     unsigned int offset, unsigned int tile) {
+	unsigned int i, g;
+
+	/* Start each syndrome from the parity we were
+	 * given.  */
+	for (g = 0; g < num_rows; ++g) {
+		llr_xorgf_zero_slice(row_block(syndromes, g),
+				     row_offset(g, tile), tile);
+		llr_xorgf_acc_mul_slice_to(row_block(syndromes, g),
+					   row_offset(g, tile), 1,
+					   parity_blocks[first + g],
+					   offset, tile);
+	}
+
+	/* Add in the recomputed parity.  */
+	for (i = 0; i < num_data_blocks; ++i) {
+		/* Skip data blocks that are all-0s/nonexistent.  */
+		if (!data_blocks[i])
+			continue;
+		for (g = 0; g < num_rows; ++g) {
+			llr_xorgf_acc_mul_slice_to(
+				row_block(syndromes, g),
+				row_offset(g, tile),
+				llr_cauchy(i, first + g),
+				data_blocks[i],
+				offset, tile
+			);
+		}
+	}
+}
+
+int llr_verify(void const* const* data_blocks,
+	       unsigned int num_data_blocks,
+	       void const* const* parity_blocks,
+	       unsigned int num_parity_blocks,
+	       void* scratch_space,
+	       unsigned char* mismatches) {
+	unsigned char* syndromes = (unsigned char*) scratch_space;
+	unsigned int first, num_rows, tile, offset;
+	unsigned int g;
+	int result = 0;
+
+	if (mismatches)
+		llr_memzero(mismatches, (num_parity_blocks + 7) / 8);
+
+	/* Work on up to MAX_ROWS parity blocks at a time.  */
+	for (first = 0; first < num_parity_blocks; first += num_rows) {
+		num_rows = num_parity_blocks - first;
+		if (num_rows > MAX_ROWS)
+			num_rows = MAX_ROWS;
+		tile = tile_size(num_rows);
+
+		for (offset = 0; offset < PLANE_SIZE; offset += tile) {
+			build_syndromes(syndromes,
+					data_blocks, num_data_blocks,
+					parity_blocks, first, num_rows,
+					offset, tile);
+
+			/* Check.  */
+			for (g = 0; g < num_rows; ++g) {
+				unsigned int j = first + g;
+				if (llr_xorgf_is_zero_slice(syndromes,
+							    row_offset(g, tile), tile))
+					continue;
+				result = 1;
+				if (!mismatches)
+					return result;
+				mismatches[j / 8] |= 1 << (j % 8);
+			}
+		}
+	}
+
+	return result;
+}
+
+unsigned int llr_locate_scratch_size(unsigned int num_parity_blocks) {
+	return ((num_parity_blocks + MAX_ROWS - 1) / MAX_ROWS) *
+	       LLR_XORGF_BLOCK_SIZE;
+}
+
+/* Find the data block whose column of the Cauchy matrix
+ * matches the given syndromes, or return num_data_blocks
+ * if there is none.  */
+static
+unsigned int find_column(unsigned char const* s,
+			 unsigned int num_parity_blocks,
+			 unsigned int num_data_blocks) {
+	/* Row 0 of the Cauchy matrix is all 1s, so a single bad
+	 * data block e, off by E, gives syndromes
+	 * s[j] = C[j][e] * E, with s[0] = E.  */
+	unsigned char r = llr_gf_reciprocal(s[0]);
+	unsigned int e, j;
+
+	for (e = 0; e < num_data_blocks; ++e) {
+		for (j = 1; j < num_parity_blocks; ++j) {
+			if (llr_gf_mul(s[j], r) != llr_cauchy(e, j))
+				break;
+		}
+		if (j == num_parity_blocks)
+			return e;
+	}
+	return num_data_blocks;
+}
+
+/* Classify the first nonzero element of the current tile
+ * of syndromes.  */
+static
+enum llr_locate_result classify(unsigned char* syndromes,
+				unsigned int num_data_blocks,
+				unsigned int num_parity_blocks,
+				unsigned int tile,
+				unsigned int* candidate) {
+	unsigned char s[LLR_DECODER_MAX_BLOCKS];
+	unsigned int num_nonzero = 0;
+	unsigned int last_nonzero = 0;
+	unsigned int o, b, g, k;
+	unsigned char any = 0;
+
+	/* Find a byte of the planes with a nonzero element,
+	 * then a nonzero bit within it.  */
+	for (o = 0; o < tile && !any; ++o) {
+		for (g = 0; g < num_parity_blocks; ++g) {
+			unsigned char const* p = row_byte(syndromes, g, tile, o);
+			for (k = 0; k < 8; ++k)
+				any |= p[k * PLANE_SIZE];
+		}
+	}
+	--o;
+	for (b = 0; !((any >> b) & 1); ++b)
+		;
+
+	/* Gather the syndromes of that element.  */
+	for (g = 0; g < num_parity_blocks; ++g) {
+		unsigned char const* p = row_byte(syndromes, g, tile, o);
+		unsigned char v = 0;
+		for (k = 0; k < 8; ++k)
+			v |= ((p[k * PLANE_SIZE] >> b) & 1) << k;
+		s[g] = v;
+		if (v) {
+			++num_nonzero;
+			last_nonzero = g;
+		}
+	}
+
+	/* With a single parity block, we cannot tell a bad
+	 * parity block from bad data.  */
+	if (num_parity_blocks == 1)
+		return llr_locate_unknown;
+
+	/* A bad parity block only shows up in its own
+	 * syndrome.  */
+	if (num_nonzero == 1) {
+		*candidate = last_nonzero;
+		return llr_locate_parity;
+	}
+
+	/* A bad data block shows up in every syndrome.  */
+	if (num_nonzero != num_parity_blocks)
+		return llr_locate_unknown;
+	*candidate = find_column(s, num_parity_blocks, num_data_blocks);
+	if (*candidate == num_data_blocks)
+		return llr_locate_unknown;
+	return llr_locate_data;
+}
+
+enum llr_locate_result llr_locate(void const* const* data_blocks,
+				  unsigned int num_data_blocks,
+				  void const* const* parity_blocks,
+				  unsigned int num_parity_blocks,
+				  void* scratch_space,
+				  unsigned int* bad_block) {
+	unsigned char* syndromes = (unsigned char*) scratch_space;
+	/* Column of the Cauchy matrix for the bad data block,
+	 * once we know which one it is.  */
+	unsigned char column[LLR_DECODER_MAX_BLOCKS];
+	enum llr_locate_result result = llr_locate_clean;
+	unsigned int candidate = 0;
+	unsigned int tile = tile_size(num_parity_blocks);
+	unsigned int offset, g;
+
+	for (offset = 0; offset < PLANE_SIZE; offset += tile) {
+		build_syndromes(syndromes,
+				data_blocks, num_data_blocks,
+				parity_blocks, 0, num_parity_blocks,
+				offset, tile);
+
+		if (result == llr_locate_clean) {
+			for (g = 0; g < num_parity_blocks; ++g) {
+				if (!llr_xorgf_is_zero_slice(row_block(syndromes, g),
+							     row_offset(g, tile), tile))
+					break;
+			}
+			if (g == num_parity_blocks)
+				continue;
+
+			/* First mismatch: pick the block that
+			 * explains it.  */
+			result = classify(syndromes,
+					  num_data_blocks, num_parity_blocks,
+					  tile, &candidate);
+			if (result == llr_locate_unknown)
+				return result;
+			if (result == llr_locate_data) {
+				for (g = 0; g < num_parity_blocks; ++g)
+					column[g] = llr_cauchy(candidate, g);
+			}
+		}
+
+		/* Check that the whole tile is explained by the
+		 * candidate.
+		 * For a bad data block, syndrome g must be
+		 * column[g] times syndrome 0, so adding that
+		 * product must clear it.  */
+		for (g = 0; g < num_parity_blocks; ++g) {
+			if (result == llr_locate_parity && g == candidate)
+				continue;
+			if (result == llr_locate_data) {
+				if (g == 0)
+					continue;
+				llr_xorgf_acc_mul_slice_to(row_block(syndromes, g),
+							   row_offset(g, tile),
+							   column[g],
+							   syndromes,
+							   row_offset(0, tile),
+							   tile);
+			}
+			if (!llr_xorgf_is_zero_slice(row_block(syndromes, g),
+						     row_offset(g, tile), tile))
+				return llr_locate_unknown;
+		}
+	}
+
+	*bad_block = candidate;
+	return result;
+}
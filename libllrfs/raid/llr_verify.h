@@ -0,0 +1,149 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#if !defined(RAID_LLR_VERIFY_H_)
+#define RAID_LLR_VERIFY_H_
+
+/*
+This module checks that the parity blocks of a stripe match
+its data blocks, without computing whole parity blocks.
+
+For each parity block, the syndrome is the on-disk parity
+plus the parity recomputed from the data; it is all 0s if
+and only if the parity block is correct.
+The syndromes are built one small tile at a time in a
+single block of scratch space, and checked as soon as each
+tile is complete, so a mismatch can be reported before the
+rest of the stripe is even read.
+
+When a stripe does not verify, `llr_locate` can use the
+same syndromes to work out which single block is wrong.
+*/
+
+/** llr_verify
+ *
+ * @brief Check the parity blocks of a stripe.
+ *
+ * @param data_blocks - input, the data blocks, as for
+ * `llr_encode`.
+ * Entries may be NULL for all-0 blocks.
+ * @param num_data_blocks - input, the number of data
+ * blocks.
+ * @param parity_blocks - input, the parity blocks to
+ * check.
+ * @param num_parity_blocks - input, the number of parity
+ * blocks.
+ * @param scratch_space - input, LLR_XORGF_BLOCK_SIZE bytes
+ * of scratch space.
+ * It can be reused across calls.
+ * @param mismatches - output, a bitmap of the parity blocks
+ * that do not match: bit `j % 8` of byte `j / 8` is set if
+ * parity block j is wrong.
+ * Must be `(num_parity_blocks + 7) / 8` bytes.
+ * May be NULL, in which case the check stops at the first
+ * mismatch found.
+ *
+ * @return 0 if all the parity blocks match, nonzero
+ * otherwise.
+ */
+int llr_verify(void const* const* data_blocks,
+	       unsigned int num_data_blocks,
+	       void const* const* parity_blocks,
+	       unsigned int num_parity_blocks,
+	       void* scratch_space,
+	       unsigned char* mismatches);
+
+/** llr_locate_scratch_size
+ *
+ * @brief Return the size of the scratch space needed by
+ * `llr_locate`, in bytes.
+ *
+ * @param num_parity_blocks - input, the number of parity
+ * blocks.
+ *
+ * @desc This is one LLR_XORGF_BLOCK_SIZE block per 8 parity
+ * blocks.
+ */
+unsigned int llr_locate_scratch_size(unsigned int num_parity_blocks);
+
+/** enum llr_locate_result
+ *
+ * @brief What `llr_locate` found.
+ */
+enum llr_locate_result {
+	/** All parity blocks match.  */
+	llr_locate_clean,
+	/** Exactly one data block is wrong.  */
+	llr_locate_data,
+	/** Exactly one parity block is wrong.  */
+	llr_locate_parity,
+	/** The stripe is wrong, but not in a way that a
+	 * single bad block explains.  */
+	llr_locate_unknown
+};
+
+/** llr_locate
+ *
+ * @brief Find the single inconsistent block in a stripe.
+ *
+ * @param data_blocks - input, the data blocks, as for
+ * `llr_verify`.
+ * @param num_data_blocks - input, the number of data
+ * blocks.
+ * @param parity_blocks - input, the parity blocks.
+ * @param num_parity_blocks - input, the number of parity
+ * blocks.
+ * At least 2 are needed to locate anything.
+ * @param scratch_space - input, scratch space whose size is
+ * from `llr_locate_scratch_size`.
+ * @param bad_block - output, the 0-based index of the bad
+ * data or parity block.
+ * Only set for `llr_locate_data` and `llr_locate_parity`.
+ *
+ * @return the kind of block that is wrong.
+ *
+ * @desc Each parity block j has a syndrome, its stored
+ * value plus the value recomputed from the data.
+ * If only data block e is wrong, off by E, then syndrome j
+ * is `C[j][e] * E`; row 0 of our Cauchy matrix is all 1s,
+ * so the ratio of syndrome j to syndrome 0 is `C[j][e]`,
+ * which identifies e.
+ * If only parity block j is wrong, then only syndrome j is
+ * nonzero.
+ * This is checked at every byte position, in a single
+ * pass over the stripe.
+ *
+ * Once found, a bad data block can be rebuilt by passing
+ * it as lost to `llr_decoder_init`.
+ *
+ * Two or more bad blocks usually give
+ * `llr_locate_unknown`, but with few parity blocks they
+ * can look like a different single bad block.
+ */
+enum llr_locate_result llr_locate(void const* const* data_blocks,
+				  unsigned int num_data_blocks,
+				  void const* const* parity_blocks,
+				  unsigned int num_parity_blocks,
+				  void* scratch_space,
+				  unsigned int* bad_block);
+
+#endif /* !defined(RAID_LLR_VERIFY_H_) */
@@ -56,6 +56,29 @@ separate program.
  */
 #define LLR_XORGF_BLOCK_SIZE 4096
 
+/** LLR_XORGF_SLICE_SIZE
+ *
+ * @brief The granularity, in bytes, of the slices
+ * processed by `llr_xorgf_acc_mul_slice`.
+ *
+ * @desc Each block is stored as 8 bit-planes of
+ * `LLR_XORGF_BLOCK_SIZE / 8` bytes each.
+ * A slice covers the same range of bytes in each of
+ * the 8 planes.
+ * This must be a multiple of the widest unit type
+ * the kernels may be compiled with (64 bytes for
+ * 512-bit SIMD), and must divide
+ * `LLR_XORGF_BLOCK_SIZE / 8`.
+ */
+#define LLR_XORGF_SLICE_SIZE 64
+
+/** LLR_XORGF_XOR_MAX
+ *
+ * @brief The number of sources `llr_xorgf_xor_n` combines
+ * in a single pass over the destination.
+ */
+#define LLR_XORGF_XOR_MAX 16
+
 /** llr_xorgf_acc_mul
  *
  * Multiply c to the entire byte vector, then add the result
@@ -84,4 +107,385 @@ separate program.
  */
 void llr_xorgf_acc_mul(void* restrict acc, unsigned char c, void const* restrict a);
 
+/** llr_xorgf_acc_mul_n
+ *
+ * @brief Like `llr_xorgf_acc_mul`, but operates on a
+ * run of consecutive blocks in a single call.
+ *
+ * @param acc - input/output, the accumulator vector.
+ * The vector must be of `nbytes` bytes.
+ * @param c - input, the `GF(2^8)` element to multiply to all
+ * values in the vector.
+ * @param a - input, the input byte vector.
+ * The vector must be of `nbytes` bytes.
+ * This must *not* be the same vector as acc above.
+ * @param nbytes - input, the size of both vectors.
+ * Must be a multiple of LLR_XORGF_BLOCK_SIZE.
+ *
+ * @desc Each LLR_XORGF_BLOCK_SIZE sub-block is processed
+ * exactly as `llr_xorgf_acc_mul` would, so the result is
+ * the same as calling `llr_xorgf_acc_mul` on each sub-block
+ * in turn.
+ * This only looks up the multiplier for `c` once, which
+ * reduces the per-block overhead on large buffers.
+ */
+void llr_xorgf_acc_mul_n(void* restrict acc, unsigned char c, void const* restrict a,
+			 unsigned int nbytes);
+
+/** llr_xorgf_acc_mul_slice
+ *
+ * @brief Like `llr_xorgf_acc_mul`, but only processes
+ * a slice of each bit-plane of the block.
+ *
+ * @param acc - input/output, the accumulator block.
+ * This points to the start of the block, not the
+ * start of the slice.
+ * @param c - input, the `GF(2^8)` element to multiply to all
+ * values in the slice.
+ * @param a - input, the input block.
+ * This points to the start of the block, not the
+ * start of the slice.
+ * This must *not* be the same block as acc above.
+ * @param offset - input, the offset of the slice
+ * within each plane.
+ * Must be a multiple of LLR_XORGF_SLICE_SIZE.
+ * @param nbytes - input, the length of the slice
+ * within each plane.
+ * Must be a multiple of LLR_XORGF_SLICE_SIZE, and
+ * `offset + nbytes <= LLR_XORGF_BLOCK_SIZE / 8`.
+ *
+ * @desc A slice touches `8 * nbytes` bytes of each
+ * block.
+ * Calling this over all slices of a plane gives the
+ * same result as a single `llr_xorgf_acc_mul`, but lets
+ * the caller tile work across several blocks so that
+ * the tiles stay in cache.
+ */
+void llr_xorgf_acc_mul_slice(void* restrict acc, unsigned char c, void const* restrict a,
+			     unsigned int offset, unsigned int nbytes);
+
+/** llr_xorgf_acc_mul_slice_to
+ *
+ * @brief Like `llr_xorgf_acc_mul_slice`, but the slice
+ * of the accumulator may be at a different offset than
+ * the slice of the input.
+ *
+ * @param acc - input/output, the accumulator block.
+ * @param acc_offset - input, the offset of the slice
+ * within each plane of acc.
+ * Must be a multiple of LLR_XORGF_SLICE_SIZE, and
+ * `acc_offset + nbytes <= LLR_XORGF_BLOCK_SIZE / 8`.
+ * @param c - input, the `GF(2^8)` element to multiply to all
+ * values in the slice.
+ * @param a - input, the input block.
+ * @param offset - input, the offset of the slice within
+ * each plane of a.
+ * @param nbytes - input, the length of the slice
+ * within each plane.
+ *
+ * @desc This lets a caller keep slices from several
+ * blocks side by side in a single block-sized buffer.
+ */
+void llr_xorgf_acc_mul_slice_to(void* restrict acc, unsigned int acc_offset,
+				unsigned char c, void const* restrict a,
+				unsigned int offset, unsigned int nbytes);
+
+/** llr_xorgf_kernel
+ *
+ * @brief A multiplier for one specific `GF(2^8)` element,
+ * as returned by `llr_xorgf_get_kernel`.
+ *
+ * @param acc - input/output, the accumulator, pointing
+ * at the start of the slice in plane 0 of the first
+ * block.
+ * @param a - input, the input, pointing at the start of
+ * the slice in plane 0 of the first block.
+ * @param nslices - input, the length of the slice within
+ * each plane, in units of LLR_XORGF_SLICE_SIZE.
+ * @param nblocks - input, the number of consecutive
+ * blocks to process.
+ */
+typedef void (*llr_xorgf_kernel)(void* restrict acc, void const* restrict a,
+				 unsigned int nslices, unsigned int nblocks);
+
+/** llr_xorgf_get_kernel
+ *
+ * @brief Look up the multiplier for c in the variant
+ * currently in use.
+ *
+ * @desc This lets callers that apply the same factors
+ * over and over resolve them once, instead of on every
+ * call.
+ * The kernel stays usable after `llr_xorgf_set_isa`, but
+ * is then no longer the selected variant.
+ */
+llr_xorgf_kernel llr_xorgf_get_kernel(unsigned char c);
+
+/** llr_xorgf_acc_mul_diff
+ *
+ * @brief Like `llr_xorgf_acc_mul`, but multiplies the
+ * difference of two input vectors.
+ *
+ * @param acc - input/output, the accumulator vector.
+ * The vector must be of LLR_XORGF_BLOCK_SIZE bytes.
+ * @param c - input, the `GF(2^8)` element to multiply to all
+ * values in the difference.
+ * @param a - input, the first input byte vector.
+ * The vector must be of LLR_XORGF_BLOCK_SIZE bytes.
+ * @param b - input, the second input byte vector.
+ * The vector must be of LLR_XORGF_BLOCK_SIZE bytes.
+ * Neither input may be the same vector as acc.
+ *
+ * @desc Computes `acc + c * (a - b)`, which, since
+ * subtraction is also XOR, is the same as
+ * `llr_xorgf_acc_mul` on `a XOR b`, but without needing a
+ * buffer for the difference.
+ * This is the core of updating parity from the old and new
+ * versions of a data block.
+ */
+void llr_xorgf_acc_mul_diff(void* restrict acc, unsigned char c,
+			    void const* restrict a, void const* restrict b);
+
+/** llr_xorgf_acc_mul_diff_slice
+ *
+ * @brief Like `llr_xorgf_acc_mul_diff`, but only processes
+ * a slice of each bit-plane of the blocks.
+ *
+ * @desc The `offset` and `nbytes` parameters are as for
+ * `llr_xorgf_acc_mul_slice`.
+ */
+void llr_xorgf_acc_mul_diff_slice(void* restrict acc, unsigned char c,
+				  void const* restrict a, void const* restrict b,
+				  unsigned int offset, unsigned int nbytes);
+
+/** llr_xorgf_acc_mul_range
+ *
+ * @brief Like `llr_xorgf_acc_mul`, but only updates a
+ * range of bytes of the accumulator block.
+ *
+ * @param acc - input/output, the accumulator block.
+ * This points to the start of the block.
+ * @param c - input, the `GF(2^8)` element to multiply.
+ * @param a - input, the input block.
+ * This points to the start of the block.
+ * This must *not* be the same block as acc above.
+ * @param offset - input, the offset of the range within
+ * the block.
+ * Must be a multiple of LLR_XORGF_SLICE_SIZE.
+ * @param nbytes - input, the length of the range.
+ * Must be a multiple of LLR_XORGF_SLICE_SIZE, and
+ * `offset + nbytes <= LLR_XORGF_BLOCK_SIZE`.
+ *
+ * @desc Unlike `llr_xorgf_acc_mul_slice`, the range is in
+ * terms of the whole block, and may cross plane
+ * boundaries.
+ * Each output plane is one row of the bit matrix of `c`
+ * applied to the input planes at the same offsets, so the
+ * part of the range in one output plane only reads that
+ * same part of each input plane that the row uses, at
+ * most `8 * nbytes` bytes of `a` in all.
+ */
+void llr_xorgf_acc_mul_range(void* restrict acc, unsigned char c, void const* restrict a,
+			     unsigned int offset, unsigned int nbytes);
+
+/** llr_xorgf_copy_slice
+ *
+ * @brief Copy a slice of each bit-plane of a block.
+ *
+ * @param dst - output, the destination block.
+ * This points to the start of the block.
+ * @param src - input, the source block.
+ * This points to the start of the block.
+ * @param offset - input, the offset of the slice
+ * within each plane.
+ * @param nbytes - input, the length of the slice
+ * within each plane.
+ *
+ * @desc Only the slice is written; the rest of `dst` is
+ * left untouched.
+ * The same constraints as `llr_xorgf_acc_mul_slice` apply
+ * to `offset` and `nbytes`.
+ */
+void llr_xorgf_copy_slice(void* restrict dst, void const* restrict src,
+			  unsigned int offset, unsigned int nbytes);
+
+/** llr_xorgf_zero_slice
+ *
+ * @brief Clear a slice of each bit-plane of a block.
+ *
+ * @param dst - output, the block to clear.
+ * This points to the start of the block.
+ * @param offset - input, the offset of the slice
+ * within each plane.
+ * @param nbytes - input, the length of the slice
+ * within each plane.
+ */
+void llr_xorgf_zero_slice(void* dst, unsigned int offset, unsigned int nbytes);
+
+/** llr_xorgf_is_zero
+ *
+ * @brief Return nonzero if every byte of the block is 0.
+ *
+ * @desc This stops at the first bit-plane with a nonzero
+ * byte, so blocks with data are usually rejected after
+ * reading one plane, while blocks that are all 0s cost one
+ * read, much less than multiplying them.
+ */
+int llr_xorgf_is_zero(void const* a);
+
+/** llr_xorgf_is_zero_slice
+ *
+ * @brief Like `llr_xorgf_is_zero`, but only tests a slice
+ * of each bit-plane of the block.
+ *
+ * @desc The same constraints as `llr_xorgf_acc_mul_slice`
+ * apply to `offset` and `nbytes`.
+ */
+int llr_xorgf_is_zero_slice(void const* a, unsigned int offset,
+			    unsigned int nbytes);
+
+/** llr_xorgf_xor_n
+ *
+ * @brief Set a block to the sum (XOR) of several blocks.
+ *
+ * @param dst - output, the destination block.
+ * @param srcs - input, the source blocks.
+ * NULL entries are treated as all-0s blocks.
+ * They, and sources that are all 0s, are skipped.
+ * @param n - input, the number of entries in `srcs`.
+ *
+ * @desc This is the same as copying the first source
+ * and then calling `llr_xorgf_acc_mul` with a factor of 1
+ * for each of the others, but reads and writes `dst` only
+ * once for every `LLR_XORGF_XOR_MAX` sources instead of
+ * once per source.
+ * If all sources are NULL or all 0s, `dst` is cleared.
+ *
+ * `dst` must not overlap any of the sources.
+ */
+void llr_xorgf_xor_n(void* restrict dst, void const* const* srcs,
+		     unsigned int n);
+
+/** llr_xorgf_xor_batch
+ *
+ * @brief Set or add to a block the sum (XOR) of a few
+ * blocks, without checking them for 0s.
+ *
+ * @param dst - input/output, the destination block.
+ * @param srcs - input, the source blocks, none NULL.
+ * @param n - input, the number of entries in `srcs`.
+ * `1 <= n <= LLR_XORGF_XOR_MAX`
+ * @param acc - input, nonzero to add the sum to `dst`
+ * instead of replacing it.
+ *
+ * @desc This is the building block of `llr_xorgf_xor_n`,
+ * for callers that already know which sources are 0s.
+ *
+ * `dst` must not overlap any of the sources.
+ */
+void llr_xorgf_xor_batch(void* restrict dst, void const* const* srcs,
+			 unsigned int n, int acc);
+
+/** enum llr_xorgf_isa
+ *
+ * @brief The instruction set variants the kernels may
+ * be built for.
+ *
+ * @desc The generic variant uses the unit type chosen at
+ * configure time (see `LLR_XORGF_UNIT_TYPE` and
+ * `LLR_XORGF_VECTOR_SIZE`) and is always available.
+ * The others are only built when compiling for x86 with a
+ * GCC-compatible compiler, and neither of those macros
+ * nor `LLR_XORGF_NO_DISPATCH` is defined.
+ *
+ * All variants produce the same results.
+ */
+enum llr_xorgf_isa {
+	llr_xorgf_isa_generic,
+	llr_xorgf_isa_sse2,
+	llr_xorgf_isa_avx2,
+	llr_xorgf_isa_avx512,
+	llr_xorgf_isa_max = llr_xorgf_isa_avx512
+};
+
+/** enum llr_xorgf_kernels
+ *
+ * @brief The styles of multiplier kernel.
+ *
+ * @desc The unrolled kernels are one function per
+ * `GF(2^8)` element, each a straight run of XORs.
+ * They are the fastest when only a few factors are in
+ * use, but together they are far larger than the
+ * instruction cache.
+ * The compact kernel is one small function per variant
+ * that looks up which input planes to XOR into each output
+ * plane, which may win when a wide stripe uses many
+ * different factors.
+ *
+ * The unrolled kernels are the default, unless
+ * `LLR_XORGF_COMPACT` is defined at build time.
+ * `llr_xorgf_acc_mul_diff` and its slice version always use
+ * the unrolled kernels.
+ */
+enum llr_xorgf_kernels {
+	llr_xorgf_kernels_unrolled,
+	llr_xorgf_kernels_compact
+};
+
+/** llr_xorgf_set_kernels
+ *
+ * @brief Select the style of multiplier kernel.
+ *
+ * @desc Like `llr_xorgf_set_isa`, this must not be called
+ * while other threads are using this module.
+ * Both styles produce the same results.
+ */
+void llr_xorgf_set_kernels(enum llr_xorgf_kernels kernels);
+
+/** llr_xorgf_get_kernels
+ *
+ * @brief Return the style of multiplier kernel currently
+ * in use.
+ */
+enum llr_xorgf_kernels llr_xorgf_get_kernels(void);
+
+/** llr_xorgf_init
+ *
+ * @brief Select the widest instruction set variant that
+ * the running processor supports.
+ *
+ * @desc Hosted builds call this automatically when the
+ * library is loaded.
+ * Kernel builds (`__KERNEL__`) only contain the generic
+ * variant, since the others would use SIMD registers
+ * without `kernel_fpu_begin`/`kernel_fpu_end`; there this
+ * does nothing.
+ */
+void llr_xorgf_init(void);
+
+/** llr_xorgf_isa_supported
+ *
+ * @brief Determine if the given variant was built and
+ * can run on this processor.
+ *
+ * @return nonzero if supported, 0 otherwise.
+ */
+int llr_xorgf_isa_supported(enum llr_xorgf_isa isa);
+
+/** llr_xorgf_set_isa
+ *
+ * @brief Force the use of a specific variant.
+ *
+ * @desc Does nothing if the variant is not supported.
+ * This is intended for tests and benchmarks, and must not
+ * be called while other threads are using this module.
+ */
+void llr_xorgf_set_isa(enum llr_xorgf_isa isa);
+
+/** llr_xorgf_get_isa
+ *
+ * @brief Return the variant currently in use.
+ */
+enum llr_xorgf_isa llr_xorgf_get_isa(void);
+
 #endif /* !defined(RAID_LLR_XORGF_H_) */
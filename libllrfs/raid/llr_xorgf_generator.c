@@ -25,6 +25,8 @@ SOFTWARE.
 #include<stdbool.h>
 #include<stdint.h>
 #include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
 
 /* 8x8 Boolean Matrix.  */
 typedef struct {
@@ -131,6 +133,16 @@ matrix matrix_mul(matrix a, matrix b) {
 	return rv;
 }
 
+/* Count the ones in a matrix.  */
+static
+unsigned int matrix_ones(matrix m) {
+	unsigned int count = 0;
+	uint64_t num;
+	for (num = m.num; num != 0; num &= num - 1)
+		++count;
+	return count;
+}
+
 /* All the matrices.  */
 static
 matrix all[256];
@@ -193,13 +205,126 @@ void print_license(void) {
 	printf("*/\n");
 }
 
+/* Common subexpression elimination for the bit matrix.
+
+Each output row of the matrix is the XOR of some of the input
+planes.
+Rows frequently share pairs of inputs, so we can compute the XOR
+of such a pair once, as a temporary, and reuse it in every row
+that needs it.
+
+We use the greedy pair-sharing heuristic (Paar; see also Plank et
+al. on XOR scheduling for Cauchy Reed-Solomon): repeatedly find the
+pair of variables shared by the most rows, replace it with a new
+temporary, and stop when no pair is shared by two or more rows.
+Ties are broken toward the lowest-numbered pair so the output is
+deterministic.
+
+Variables 0 to 7 are the inputs, temporaries are numbered from 8.
+*/
+#define MAX_CSE_VARS 64
+
+typedef struct {
+	/* For each row, the set of variables XORed into it.  */
+	uint64_t rows[8];
+	/* The number of temporaries.  */
+	unsigned int num_temps;
+	/* The two variables each temporary is made of.  */
+	unsigned int temp_l[MAX_CSE_VARS - 8];
+	unsigned int temp_r[MAX_CSE_VARS - 8];
+} cse_result;
+
+static
+void cse_compute(cse_result* res, matrix m) {
+	unsigned int i, j, x, y;
+
+	for (j = 0; j < 8; ++j) {
+		res->rows[j] = 0;
+		for (i = 0; i < 8; ++i) {
+			if (matrix_get(m, i, j))
+				res->rows[j] |= ((uint64_t) 1) << i;
+		}
+	}
+	res->num_temps = 0;
+
+	for (;;) {
+		unsigned int num_vars = 8 + res->num_temps;
+		unsigned int best_count = 1;
+		unsigned int best_x = 0, best_y = 0;
+		uint64_t pair;
+
+		if (num_vars == MAX_CSE_VARS)
+			break;
+
+		for (x = 0; x < num_vars; ++x) {
+			for (y = x + 1; y < num_vars; ++y) {
+				unsigned int count = 0;
+				pair = (((uint64_t) 1) << x) | (((uint64_t) 1) << y);
+				for (j = 0; j < 8; ++j) {
+					if ((res->rows[j] & pair) == pair)
+						++count;
+				}
+				if (count > best_count) {
+					best_count = count;
+					best_x = x;
+					best_y = y;
+				}
+			}
+		}
+		if (best_count < 2)
+			break;
+
+		/* Replace the pair with a new temporary.  */
+		pair = (((uint64_t) 1) << best_x) | (((uint64_t) 1) << best_y);
+		for (j = 0; j < 8; ++j) {
+			if ((res->rows[j] & pair) == pair)
+				res->rows[j] = (res->rows[j] & ~pair) |
+					       (((uint64_t) 1) << num_vars);
+		}
+		res->temp_l[res->num_temps] = best_x;
+		res->temp_r[res->num_temps] = best_y;
+		++res->num_temps;
+	}
+}
+
+/* The cost of multiplying by the matrix and accumulating into
+ * the output: one XOR per variable in each row (forming the row,
+ * plus adding it to the accumulator), plus one per temporary.
+ * Without any temporaries this is just the number of ones in the
+ * matrix.
+ */
+static
+unsigned int cse_cost(cse_result const* res) {
+	unsigned int j, cost;
+	uint64_t row;
+
+	cost = res->num_temps;
+	for (j = 0; j < 8; ++j) {
+		for (row = res->rows[j]; row != 0; row &= row - 1)
+			++cost;
+	}
+	return cost;
+}
+
+static
+void print_cse_var(unsigned int var) {
+	if (var < 8)
+		printf("tmp_mul_a%u_", var);
+	else
+		printf("tmp_mul_t%u_", var);
+}
+
 static
 void make_mul_macro(unsigned int index) {
 	matrix curr = all[index];
+	cse_result cse;
 	unsigned int i, j;
 
+	cse_compute(&cse, curr);
+
 	/* Dump the matrix.  */
-	printf("/* %d\n", index);
+	printf("/* %d, cost %u (%u before sharing)\n",
+	       index, cse_cost(&cse), matrix_ones(curr));
 	for (j = 0; j < 8; ++j) {
 		for (i = 0; i < 8; ++i) {
 			if (matrix_get(curr, i, j))
@@ -218,18 +343,29 @@ void make_mul_macro(unsigned int index) {
 		printf("\t\tunit_type tmp_mul_a%d_ = (a%d); \\\n", j, j);
 	}
 
-	/* TODO: optimize number of XORs.  */
+	/* Shared subexpressions.  */
+	for (i = 0; i < cse.num_temps; ++i) {
+		printf("\t\tunit_type ");
+		print_cse_var(8 + i);
+		printf(" = ");
+		print_cse_var(cse.temp_l[i]);
+		printf(" ^ ");
+		print_cse_var(cse.temp_r[i]);
+		printf("; \\\n");
+	}
+
 	for (j = 0; j < 8; ++j) {
 		bool first = true;
 		printf("\t\tr%d =", j);
-		for (i = 0; i < 8; ++i) {
-			if (!matrix_get(curr, i, j))
+		for (i = 0; i < 8 + cse.num_temps; ++i) {
+			if (!(cse.rows[j] & (((uint64_t) 1) << i)))
 				continue;
 			if (first)
 				first = false;
 			else
 				printf(" ^");
-			printf(" tmp_mul_a%d_", i);
+			printf(" ");
+			print_cse_var(i);
 		}
 		if (first)
 			printf(" 0");
@@ -240,101 +376,704 @@ void make_mul_macro(unsigned int index) {
 	printf("\n");
 }
 
-void make_acc_mul(void) {
+/* Instruction set variants of the kernels.
+ * The generic variant is always built, and uses whatever
+ * unit type was selected at configure time.
+ * The others are only built when we can select between
+ * them at runtime, i.e. with GCC-compatible compilers on
+ * x86 (LLR_XORGF_DISPATCH).
+ */
+struct isa_variant {
+	/* Suffix for the function and table names.  */
+	char const* name;
+	/* Enumerator in enum llr_xorgf_isa.  */
+	char const* isa;
+	/* Vector size in bytes, or 0 for the generic variant.  */
+	unsigned int vector_size;
+	/* Argument to __attribute__((target(...))).  */
+	char const* target;
+	/* Argument to __builtin_cpu_supports.  */
+	char const* cpu_feature;
+};
+/* Tuning options, from the command line (see `make autotune`).
+ * The defaults give the same code as without options.  */
+/* How many slices the unrolled kernels handle per loop
+ * iteration.  */
+static unsigned int opt_unroll = 1;
+/* How many slices ahead the unrolled kernels prefetch
+ * their inputs, or 0 for no prefetching.  */
+static unsigned int opt_prefetch = 0;
+/* The variant llr_xorgf_init should pick when supported,
+ * instead of the widest one, or NULL.  */
+static char const* opt_prefer_isa = NULL;
+
+static
+struct isa_variant const isa_variants[] = {
+	{"generic", "llr_xorgf_isa_generic", 0, NULL, NULL},
+	{"sse2", "llr_xorgf_isa_sse2", 16, "sse2", "sse2"},
+	{"avx2", "llr_xorgf_isa_avx2", 32, "avx2", "avx2"},
+	{"avx512", "llr_xorgf_isa_avx512", 64, "avx512f", "avx512f"}
+};
+#define NUM_ISA_VARIANTS (sizeof(isa_variants) / sizeof(isa_variants[0]))
+
+/* Generate the individual accumulator functions.
+ * Each one processes the first nslices slices of
+ * each plane, over nblocks consecutive blocks of
+ * LLR_XORGF_BLOCK_SIZE bytes.
+ * Passing nslices == slices_per_plane processes whole
+ * blocks, so that callers with large buffers only
+ * need to dispatch once.
+ * Passing fewer slices (with acc and a offset into
+ * the planes) processes part of each plane, for
+ * callers that tile their work to stay in cache.
+ * The innermost loop always covers exactly one
+ * slice so that the compiler sees a constant trip
+ * count.
+ *
+ * With diff, the functions take a second input b, and
+ * multiply a - b (i.e. a XOR b) instead of a, without
+ * storing the difference anywhere.
+ */
+static
+void make_acc_mul_family(struct isa_variant const* v, bool diff) {
+	char const* family = diff ? "acc_mul_diff" : "acc_mul";
+	char const* b_param = diff ? ", void const* restrict orig_b" : "";
 	unsigned int i, j;
 
-	/* Generate the individual accumulator functions.  */
-	printf("static void llr_xorgf_acc_mul_0(void* restrict acc, void const* restrict a) { /* Do Nothing.  */ }\n");
-	printf("static void llr_xorgf_acc_mul_1(void* restrict orig_acc, void const* restrict orig_a) {\n");
+	printf("static LLR_XORGF_TARGET void llr_xorgf_%s_%s_0(void* restrict orig_acc, void const* restrict orig_a%s, unsigned int nslices, unsigned int nblocks) { /* Do Nothing.  */ }\n",
+	       family, v->name, b_param);
+	printf("static LLR_XORGF_TARGET void llr_xorgf_%s_%s_1(void* restrict orig_acc, void const* restrict orig_a%s, unsigned int nslices, unsigned int nblocks) {\n",
+	       family, v->name, b_param);
 	printf("\tunit_type* acc = (unit_type*) orig_acc;\n");
 	printf("\tunit_type const* a = (unit_type const*) orig_a;\n");
-	printf("\tunsigned int i;\n\n");
-	printf("\tfor (i = 0; i < span * 8; ++i) {\n");
-	printf("\t\tacc[i] ^= a[i];\n");
+	if (diff)
+		printf("\tunit_type const* b = (unit_type const*) orig_b;\n");
+	printf("\tunsigned int i, j;\n\n");
+	printf("\tfor (; nblocks != 0; --nblocks) {\n");
+	printf("\t\tfor (j = 0; j < 8; ++j) {\n");
+	printf("\t\t\tfor (i = 0; i < nslices * slice_span; ++i)\n");
+	if (diff)
+		printf("\t\t\t\tacc[i] ^= a[i] ^ b[i];\n");
+	else
+		printf("\t\t\t\tacc[i] ^= a[i];\n");
+	printf("\t\t\tacc += span;\n");
+	printf("\t\t\ta += span;\n");
+	if (diff)
+		printf("\t\t\tb += span;\n");
+	printf("\t\t}\n");
 	printf("\t}\n");
 	printf("}\n");
 	for (i = 2; i < 256; ++i) {
-		printf("static void llr_xorgf_acc_mul_%u(void* restrict orig_acc, void const* restrict orig_a) {\n", i);
+		printf("static LLR_XORGF_TARGET void llr_xorgf_%s_%s_%u(void* restrict orig_acc, void const* restrict orig_a%s, unsigned int nslices, unsigned int nblocks) {\n",
+		       family, v->name, i, b_param);
 		printf("\tunit_type* acc = (unit_type*) orig_acc;\n");
 		printf("\tunit_type const* a = (unit_type const*) orig_a;\n");
-		printf("\tunsigned int i;\n");
+		if (diff)
+			printf("\tunit_type const* b = (unit_type const*) orig_b;\n");
+		printf("\tunsigned int i, s;\n");
 		for (j = 0; j < 8; ++j)
 			printf("\tunit_type t%u;\n", j);
 		printf("\n");
-		printf("\tfor (i = 0; i < span; ++i) {\n");
-		printf("\t\tMUL%u(\n", i);
+		printf("\tfor (; nblocks != 0; --nblocks) {\n");
+		if (opt_unroll > 1)
+			printf("\t\tLLR_XORGF_UNROLL\n");
+		printf("\t\tfor (s = 0; s < nslices; ++s) {\n");
+		for (j = 0; j < 8 && opt_prefetch != 0; ++j) {
+			printf("\t\t\tLLR_XORGF_PREFETCH(&a[%u * span + %u * slice_span]);\n",
+			       j, opt_prefetch);
+			if (diff)
+				printf("\t\t\tLLR_XORGF_PREFETCH(&b[%u * span + %u * slice_span]);\n",
+				       j, opt_prefetch);
+		}
+		printf("\t\t\tfor (i = 0; i < slice_span; ++i) {\n");
+		printf("\t\t\t\tMUL%u(\n", i);
 		for (j = 0; j < 8; ++j) {
-			printf("\t\t\tt%u,\n",j);
+			printf("\t\t\t\t\tt%u,\n",j);
 		}
 		for (j = 0; j < 8; ++j) {
-			printf("\t\t\ta[%u * span]%s\n", j, j == 7 ? "" : ",");
+			if (diff)
+				printf("\t\t\t\t\ta[%u * span] ^ b[%u * span]%s\n",
+				       j, j, j == 7 ? "" : ",");
+			else
+				printf("\t\t\t\t\ta[%u * span]%s\n", j, j == 7 ? "" : ",");
 		}
-		printf("\t\t\t);\n");
+		printf("\t\t\t\t\t);\n");
 		for (j = 0; j < 8; ++j) {
-			printf("\t\tacc[%u * span] ^= t%u;\n", j, j);
+			printf("\t\t\t\tacc[%u * span] ^= t%u;\n", j, j);
 		}
-		printf("\t\t++acc;\n");
-		printf("\t\t++a;\n");
+		printf("\t\t\t\t++acc;\n");
+		printf("\t\t\t\t++a;\n");
+		if (diff)
+			printf("\t\t\t\t++b;\n");
+		printf("\t\t\t}\n");
+		printf("\t\t}\n");
+		/* Skip the rest of the 8 planes to reach the same
+		 * offset in the next block.  */
+		printf("\t\tacc += 8 * span - nslices * slice_span;\n");
+		printf("\t\ta += 8 * span - nslices * slice_span;\n");
+		if (diff)
+			printf("\t\tb += 8 * span - nslices * slice_span;\n");
 		printf("\t}\n");
 		printf("}\n");
 	}
 
 	/* Generate the table.  */
-	printf("typedef void (*llr_xorgf_acc_mul_func)(void* restrict acc, void const* restrict a);\n");
-	printf("static llr_xorgf_acc_mul_func const llr_xorgf_acc_mul_table[256] = {\n");
+	printf("static llr_xorgf_%s_func const llr_xorgf_%s_table_%s[256] = {\n",
+	       family, family, v->name);
+	for (i = 0; i < 256; ++i) {
+		printf("\tllr_xorgf_%s_%s_%u%s\n",
+		       family, v->name, i, (i == 255) ? "" : ",");
+	}
+	printf("};\n");
+}
+
+static
+void make_acc_mul(struct isa_variant const* v) {
+	make_acc_mul_family(v, false);
+	make_acc_mul_family(v, true);
+}
+
+/* Generate the row functions used by llr_xorgf_acc_mul_range:
+ * for each n up to 8, one that adds n runs of nslices
+ * slices (the selected input planes, at the same offset)
+ * into a run of one output plane, in a single pass.  */
+static
+void make_acc_mul_row(struct isa_variant const* v) {
+	unsigned int n, i;
+
+	for (n = 1; n <= 8; ++n) {
+		printf("static LLR_XORGF_TARGET void llr_xorgf_acc_mul_row_%s_%u(void* restrict orig_acc, void const* const* srcs, unsigned int nslices) {\n",
+		       v->name, n);
+		printf("\tunit_type* restrict acc = (unit_type*) orig_acc;\n");
+		for (i = 0; i < n; ++i)
+			printf("\tunit_type const* restrict s%u = (unit_type const*) srcs[%u];\n",
+			       i, i);
+		printf("\tunsigned int i;\n\n");
+		printf("\tfor (i = 0; i < nslices * slice_span; ++i)\n");
+		printf("\t\tacc[i] ^= ");
+		for (i = 0; i < n; ++i)
+			printf("%ss%u[i]", i == 0 ? "" : " ^ ", i);
+		printf(";\n");
+		printf("}\n");
+	}
+	printf("static llr_xorgf_acc_mul_row_func const llr_xorgf_acc_mul_row_table_%s[8] = {\n",
+	       v->name);
+	for (n = 1; n <= 8; ++n)
+		printf("\tllr_xorgf_acc_mul_row_%s_%u%s\n",
+		       v->name, n, n == 8 ? "" : ",");
+	printf("};\n");
+}
+
+/* Generate the zero test: OR together the requested part of
+ * each plane, and stop at the first plane that is not all
+ * 0s, so that blocks with data are rejected quickly.
+ * Testing the accumulated unit is the expensive part, so
+ * only do it once per plane.  */
+static
+void make_is_zero(struct isa_variant const* v) {
+	printf("static LLR_XORGF_TARGET int llr_xorgf_is_zero_%s(void const* orig_a, unsigned int nslices) {\n",
+	       v->name);
+	printf("\tunit_type const* a = (unit_type const*) orig_a;\n");
+	printf("\tunsigned int i, k;\n\n");
+	printf("\tfor (k = 0; k < 8; ++k) {\n");
+	printf("\t\tunit_type t = a[0];\n");
+	printf("\t\tunit_type z;\n");
+	printf("\t\tfor (i = 1; i < nslices * slice_span; ++i)\n");
+	printf("\t\t\tt |= a[i];\n");
+	printf("\t\tz = t ^ t;\n");
+	printf("\t\tif (memcmp(&t, &z, sizeof(unit_type)) != 0)\n");
+	printf("\t\t\treturn 0;\n");
+	printf("\t\ta += span;\n");
+	printf("\t}\n");
+	printf("\treturn 1;\n");
+	printf("}\n");
+}
+
+/* Generate the N-way XOR functions: for each n up to
+ * XOR_MAX, one that sets the destination to the XOR of n
+ * sources, and one that adds n sources to it, each in a
+ * single pass.  */
+#define XOR_MAX 16
+static
+void make_xor_n(struct isa_variant const* v) {
+	unsigned int n, i;
+	int acc;
+
+	for (acc = 0; acc < 2; ++acc) {
+		for (n = 1; n <= XOR_MAX; ++n) {
+			printf("static LLR_XORGF_TARGET void llr_xorgf_xor_%s_%s_%u(void* restrict orig_dst, void const* const* srcs) {\n",
+			       acc ? "acc" : "set", v->name, n);
+			printf("\tunit_type* restrict dst = (unit_type*) orig_dst;\n");
+			for (i = 0; i < n; ++i)
+				printf("\tunit_type const* restrict s%u = (unit_type const*) srcs[%u];\n",
+				       i, i);
+			printf("\tunsigned int i;\n\n");
+			printf("\tfor (i = 0; i < LLR_XORGF_BLOCK_SIZE / sizeof(unit_type); ++i)\n");
+			printf("\t\tdst[i] = %s", acc ? "dst[i] ^ " : "");
+			for (i = 0; i < n; ++i)
+				printf("%ss%u[i]", i == 0 ? "" : " ^ ", i);
+			printf(";\n");
+			printf("}\n");
+		}
+	}
+	printf("static llr_xorgf_xor_func const llr_xorgf_xor_table_%s[2][LLR_XORGF_XOR_MAX] = {\n",
+	       v->name);
+	for (acc = 0; acc < 2; ++acc) {
+		printf("\t{\n");
+		for (n = 1; n <= XOR_MAX; ++n)
+			printf("\t\tllr_xorgf_xor_%s_%s_%u%s\n",
+			       acc ? "acc" : "set", v->name, n,
+			       n == XOR_MAX ? "" : ",");
+		printf("\t}%s\n", acc ? "" : ",");
+	}
+	printf("};\n");
+}
+
+/* Generate the compact kernel: a single function for all
+ * factors, driven by the row masks of the factor's bit
+ * matrix, plus a table of tiny wrappers so that it can be
+ * dispatched like the unrolled functions.
+ * Its code is a small fraction of the size of the 254
+ * unrolled functions, at the cost of masking and XORing
+ * all 64 input/output pairs for every unit.
+ * It must not be inlined into the wrappers, or the
+ * compiler would specialize it right back into 254
+ * unrolled functions.
+ */
+static
+void make_compact(struct isa_variant const* v) {
+	unsigned int i;
+
+	printf("static LLR_XORGF_TARGET LLR_XORGF_NOINLINE void llr_xorgf_acc_mul_compact_%s(void* restrict orig_acc, void const* restrict orig_a, unsigned int nslices, unsigned int nblocks, unsigned char c) {\n",
+	       v->name);
+	printf("\tunit_type* acc = (unit_type*) orig_acc;\n");
+	printf("\tunit_type const* a = (unit_type const*) orig_a;\n");
+	printf("\tunsigned char const* masks = llr_xorgf_rowmasks[c];\n");
+	printf("\tunsigned long long sel[8][8];\n");
+	printf("\tunsigned int i, s, j, k;\n\n");
+	/* Turn the mask bits into all-zeros or all-ones words
+	 * once per call, so that the loop has no branches that
+	 * depend on the factor.
+	 * The words are widened to the unit in the loop, which
+	 * vector units can do as part of the AND.  */
+	printf("\tfor (j = 0; j < 8; ++j) {\n");
+	printf("\t\tfor (k = 0; k < 8; ++k)\n");
+	printf("\t\t\tsel[j][k] = 0ULL - ((masks[j] >> k) & 1u);\n");
+	printf("\t}\n\n");
+	printf("\tfor (; nblocks != 0; --nblocks) {\n");
+	printf("\t\tfor (s = 0; s < nslices; ++s) {\n");
+	printf("\t\t\tfor (i = 0; i < slice_span; ++i) {\n");
+	printf("\t\t\t\tunit_type in[8];\n");
+	printf("\t\t\t\tfor (k = 0; k < 8; ++k)\n");
+	printf("\t\t\t\t\tin[k] = a[k * span];\n");
+	printf("\t\t\t\tfor (j = 0; j < 8; ++j) {\n");
+	printf("\t\t\t\t\tunit_type t = in[0] & sel[j][0];\n");
+	printf("\t\t\t\t\tfor (k = 1; k < 8; ++k)\n");
+	printf("\t\t\t\t\t\tt ^= in[k] & sel[j][k];\n");
+	printf("\t\t\t\t\tacc[j * span] ^= t;\n");
+	printf("\t\t\t\t}\n");
+	printf("\t\t\t\t++acc;\n");
+	printf("\t\t\t\t++a;\n");
+	printf("\t\t\t}\n");
+	printf("\t\t}\n");
+	printf("\t\tacc += 8 * span - nslices * slice_span;\n");
+	printf("\t\ta += 8 * span - nslices * slice_span;\n");
+	printf("\t}\n");
+	printf("}\n");
+
+	/* 0 and 1 are already small.  */
+	for (i = 2; i < 256; ++i) {
+		printf("static LLR_XORGF_TARGET void llr_xorgf_acc_mul_compact_%s_%u(void* restrict acc, void const* restrict a, unsigned int nslices, unsigned int nblocks) {\n",
+		       v->name, i);
+		printf("\tllr_xorgf_acc_mul_compact_%s(acc, a, nslices, nblocks, %u);\n",
+		       v->name, i);
+		printf("}\n");
+	}
+	printf("static llr_xorgf_acc_mul_func const llr_xorgf_acc_mul_compact_table_%s[256] = {\n",
+	       v->name);
 	for (i = 0; i < 256; ++i) {
-		printf("\tllr_xorgf_acc_mul_%u%s\n",
-		       i, (i == 255) ? "" : ",");
+		if (i < 2)
+			printf("\tllr_xorgf_acc_mul_%s_%u,\n", v->name, i);
+		else
+			printf("\tllr_xorgf_acc_mul_compact_%s_%u%s\n",
+			       v->name, i, (i == 255) ? "" : ",");
 	}
 	printf("};\n");
+}
+
+/* The row masks used by the compact kernels: bit k of
+ * entry j for factor c is set if input plane k is added
+ * into output plane j.  */
+static
+void make_rowmasks(void) {
+	unsigned int c, i, j;
 
-	/* Generate the dispatch function.  */
+	printf("static unsigned char const llr_xorgf_rowmasks[256][8] = {\n");
+	for (c = 0; c < 256; ++c) {
+		printf("\t{");
+		for (j = 0; j < 8; ++j) {
+			unsigned int mask = 0;
+			for (i = 0; i < 8; ++i) {
+				if (matrix_get(all[c], i, j))
+					mask |= 1u << i;
+			}
+			printf("0x%02x%s", mask, j == 7 ? "" : ", ");
+		}
+		printf("}%s\n", c == 255 ? "" : ",");
+	}
+	printf("};\n\n");
+}
+
+static
+void make_variant(struct isa_variant const* v) {
+	printf("\n/* Variant: %s.  */\n", v->name);
+	if (v->vector_size != 0) {
+		printf("#if defined(LLR_XORGF_DISPATCH)\n");
+		/* Buffers (and slices within them) need not be
+		 * aligned to the vector size.  */
+		printf("typedef unsigned long long llr_xorgf_unit_%s __attribute__((vector_size(%u), aligned(1)));\n",
+		       v->name, v->vector_size);
+		printf("#define LLR_XORGF_TARGET __attribute__((target(\"%s\")))\n", v->target);
+	} else {
+		printf("#define LLR_XORGF_TARGET\n");
+	}
+	printf("#define unit_type llr_xorgf_unit_%s\n", v->name);
+	/* Slices must be made of whole units.  */
+	printf("typedef char llr_xorgf_slice_size_check_%s[(LLR_XORGF_SLICE_SIZE %% sizeof(unit_type)) == 0 ? 1 : -1];\n\n",
+	       v->name);
+	make_acc_mul(v);
+	make_compact(v);
+	make_xor_n(v);
+	make_acc_mul_row(v);
+	make_is_zero(v);
+	printf("#undef unit_type\n");
+	printf("#undef LLR_XORGF_TARGET\n");
+	if (v->vector_size != 0)
+		printf("#endif /* defined(LLR_XORGF_DISPATCH) */\n");
+}
+
+static
+void make_dispatch(void) {
+	unsigned int i;
+
+	/* The currently selected table.  */
+	printf("\n#if defined(LLR_XORGF_COMPACT)\n");
+	printf("static llr_xorgf_acc_mul_func const* llr_xorgf_acc_mul_table = llr_xorgf_acc_mul_compact_table_generic;\n");
+	printf("static enum llr_xorgf_kernels llr_xorgf_current_kernels = llr_xorgf_kernels_compact;\n");
+	printf("#else /* !defined(LLR_XORGF_COMPACT) */\n");
+	printf("static llr_xorgf_acc_mul_func const* llr_xorgf_acc_mul_table = llr_xorgf_acc_mul_table_generic;\n");
+	printf("static enum llr_xorgf_kernels llr_xorgf_current_kernels = llr_xorgf_kernels_unrolled;\n");
+	printf("#endif /* !defined(LLR_XORGF_COMPACT) */\n");
+	printf("static llr_xorgf_acc_mul_diff_func const* llr_xorgf_acc_mul_diff_table = llr_xorgf_acc_mul_diff_table_generic;\n");
+	printf("static llr_xorgf_xor_func const (*llr_xorgf_xor_table)[LLR_XORGF_XOR_MAX] = llr_xorgf_xor_table_generic;\n");
+	printf("static llr_xorgf_acc_mul_row_func const* llr_xorgf_acc_mul_row_table = llr_xorgf_acc_mul_row_table_generic;\n");
+	printf("static llr_xorgf_is_zero_func llr_xorgf_is_zero_impl = llr_xorgf_is_zero_generic;\n");
+	printf("static enum llr_xorgf_isa llr_xorgf_current_isa = llr_xorgf_isa_generic;\n");
+
+	printf("\nint llr_xorgf_isa_supported(enum llr_xorgf_isa isa) {\n");
+	printf("\tswitch (isa) {\n");
+	printf("\tcase llr_xorgf_isa_generic:\n");
+	printf("\t\treturn 1;\n");
+	printf("#if defined(LLR_XORGF_DISPATCH)\n");
+	for (i = 1; i < NUM_ISA_VARIANTS; ++i) {
+		printf("\tcase %s:\n", isa_variants[i].isa);
+		printf("\t\treturn !!__builtin_cpu_supports(\"%s\");\n",
+		       isa_variants[i].cpu_feature);
+	}
+	printf("#endif /* defined(LLR_XORGF_DISPATCH) */\n");
+	printf("\tdefault:\n");
+	printf("\t\treturn 0;\n");
+	printf("\t}\n");
+	printf("}\n");
+
+	printf("\nvoid llr_xorgf_set_isa(enum llr_xorgf_isa isa) {\n");
+	printf("\tint compact = llr_xorgf_current_kernels == llr_xorgf_kernels_compact;\n\n");
+	printf("\tif (!llr_xorgf_isa_supported(isa))\n");
+	printf("\t\treturn;\n");
+	printf("\tswitch (isa) {\n");
+	printf("#if defined(LLR_XORGF_DISPATCH)\n");
+	for (i = 1; i < NUM_ISA_VARIANTS; ++i) {
+		printf("\tcase %s:\n", isa_variants[i].isa);
+		printf("\t\tllr_xorgf_acc_mul_table = compact ? llr_xorgf_acc_mul_compact_table_%s : llr_xorgf_acc_mul_table_%s;\n",
+		       isa_variants[i].name, isa_variants[i].name);
+		printf("\t\tllr_xorgf_acc_mul_diff_table = llr_xorgf_acc_mul_diff_table_%s;\n",
+		       isa_variants[i].name);
+		printf("\t\tllr_xorgf_xor_table = llr_xorgf_xor_table_%s;\n",
+		       isa_variants[i].name);
+		printf("\t\tllr_xorgf_acc_mul_row_table = llr_xorgf_acc_mul_row_table_%s;\n",
+		       isa_variants[i].name);
+		printf("\t\tllr_xorgf_is_zero_impl = llr_xorgf_is_zero_%s;\n",
+		       isa_variants[i].name);
+		printf("\t\tbreak;\n");
+	}
+	printf("#endif /* defined(LLR_XORGF_DISPATCH) */\n");
+	printf("\tdefault:\n");
+	printf("\t\tllr_xorgf_acc_mul_table = compact ? llr_xorgf_acc_mul_compact_table_generic : llr_xorgf_acc_mul_table_generic;\n");
+	printf("\t\tllr_xorgf_acc_mul_diff_table = llr_xorgf_acc_mul_diff_table_generic;\n");
+	printf("\t\tllr_xorgf_xor_table = llr_xorgf_xor_table_generic;\n");
+	printf("\t\tllr_xorgf_acc_mul_row_table = llr_xorgf_acc_mul_row_table_generic;\n");
+	printf("\t\tllr_xorgf_is_zero_impl = llr_xorgf_is_zero_generic;\n");
+	printf("\t\tbreak;\n");
+	printf("\t}\n");
+	printf("\tllr_xorgf_current_isa = isa;\n");
+	printf("}\n");
+
+	printf("\nvoid llr_xorgf_set_kernels(enum llr_xorgf_kernels kernels) {\n");
+	printf("\tllr_xorgf_current_kernels = kernels;\n");
+	printf("\tllr_xorgf_set_isa(llr_xorgf_current_isa);\n");
+	printf("}\n");
+
+	printf("\nenum llr_xorgf_kernels llr_xorgf_get_kernels(void) {\n");
+	printf("\treturn llr_xorgf_current_kernels;\n");
+	printf("}\n");
+
+	printf("\nenum llr_xorgf_isa llr_xorgf_get_isa(void) {\n");
+	printf("\treturn llr_xorgf_current_isa;\n");
+	printf("}\n");
+
+	/* Pick the widest supported variant.  */
+	printf("\nvoid llr_xorgf_init(void) {\n");
+	printf("#if defined(LLR_XORGF_DISPATCH)\n");
+	printf("\tint isa;\n\n");
+	printf("\t__builtin_cpu_init();\n");
+	printf("\tfor (isa = llr_xorgf_isa_max; isa > llr_xorgf_isa_generic; --isa) {\n");
+	printf("\t\tif (llr_xorgf_isa_supported((enum llr_xorgf_isa) isa))\n");
+	printf("\t\t\tbreak;\n");
+	printf("\t}\n");
+	for (i = 0; i < NUM_ISA_VARIANTS && opt_prefer_isa; ++i) {
+		if (strcmp(opt_prefer_isa, isa_variants[i].name) != 0)
+			continue;
+		printf("\t/* Tuned for the build host.  */\n");
+		printf("\tif (llr_xorgf_isa_supported(%s))\n", isa_variants[i].isa);
+		printf("\t\tisa = %s;\n", isa_variants[i].isa);
+	}
+	printf("\tllr_xorgf_set_isa((enum llr_xorgf_isa) isa);\n");
+	printf("#endif /* defined(LLR_XORGF_DISPATCH) */\n");
+	printf("}\n");
+	/* Hosted builds select automatically on load.  */
+	printf("#if defined(LLR_XORGF_DISPATCH)\n");
+	printf("__attribute__((constructor))\n");
+	printf("static void llr_xorgf_init_on_load(void) {\n");
+	printf("\tllr_xorgf_init();\n");
+	printf("}\n");
+	printf("#endif /* defined(LLR_XORGF_DISPATCH) */\n");
+
+	/* Generate the dispatch functions.  */
 	printf("\nvoid llr_xorgf_acc_mul(void* restrict acc, unsigned char c, void const* restrict a) {\n");
-	printf("\tllr_xorgf_acc_mul_table[c](acc, a);");
+	printf("\tllr_xorgf_acc_mul_table[c](acc, a, slices_per_plane, 1);\n");
+	printf("}\n");
+	printf("\nvoid llr_xorgf_acc_mul_n(void* restrict acc, unsigned char c, void const* restrict a, unsigned int nbytes) {\n");
+	printf("\tllr_xorgf_acc_mul_table[c](acc, a, slices_per_plane, nbytes / LLR_XORGF_BLOCK_SIZE);\n");
+	printf("}\n");
+	printf("\nvoid llr_xorgf_acc_mul_slice(void* restrict acc, unsigned char c, void const* restrict a, unsigned int offset, unsigned int nbytes) {\n");
+	printf("\tllr_xorgf_acc_mul_table[c]((unsigned char*) acc + offset,\n");
+	printf("\t\t\t\t   (unsigned char const*) a + offset,\n");
+	printf("\t\t\t\t   nbytes / LLR_XORGF_SLICE_SIZE, 1);\n");
+	printf("}\n");
+
+	printf("\nvoid llr_xorgf_acc_mul_slice_to(void* restrict acc, unsigned int acc_offset, unsigned char c, void const* restrict a, unsigned int offset, unsigned int nbytes) {\n");
+	printf("\tllr_xorgf_acc_mul_table[c]((unsigned char*) acc + acc_offset,\n");
+	printf("\t\t\t\t   (unsigned char const*) a + offset,\n");
+	printf("\t\t\t\t   nbytes / LLR_XORGF_SLICE_SIZE, 1);\n");
+	printf("}\n");
+	/* Split the range at plane boundaries; each piece of an
+	 * output plane needs one row of the factor's matrix.  */
+	printf("\nvoid llr_xorgf_acc_mul_range(void* restrict acc, unsigned char c, void const* restrict a, unsigned int offset, unsigned int nbytes) {\n");
+	printf("\twhile (nbytes != 0) {\n");
+	printf("\t\tunsigned int plane = offset / (LLR_XORGF_BLOCK_SIZE / 8);\n");
+	printf("\t\tunsigned int at = offset %% (LLR_XORGF_BLOCK_SIZE / 8);\n");
+	printf("\t\tunsigned int len = (LLR_XORGF_BLOCK_SIZE / 8) - at;\n");
+	printf("\t\tunsigned int mask = llr_xorgf_rowmasks[c][plane];\n");
+	printf("\t\tvoid const* srcs[8];\n");
+	printf("\t\tunsigned int k, n = 0;\n\n");
+	printf("\t\tif (len > nbytes)\n");
+	printf("\t\t\tlen = nbytes;\n");
+	printf("\t\tfor (k = 0; k < 8; ++k) {\n");
+	printf("\t\t\tif (mask & (1u << k))\n");
+	printf("\t\t\t\tsrcs[n++] = (unsigned char const*) a + k * (LLR_XORGF_BLOCK_SIZE / 8) + at;\n");
+	printf("\t\t}\n");
+	printf("\t\tif (n != 0)\n");
+	printf("\t\t\tllr_xorgf_acc_mul_row_table[n - 1]((unsigned char*) acc + offset, srcs,\n");
+	printf("\t\t\t\t\t\t\t    len / LLR_XORGF_SLICE_SIZE);\n");
+	printf("\t\toffset += len;\n");
+	printf("\t\tnbytes -= len;\n");
+	printf("\t}\n");
+	printf("}\n");
+	printf("\nllr_xorgf_kernel llr_xorgf_get_kernel(unsigned char c) {\n");
+	printf("\treturn llr_xorgf_acc_mul_table[c];\n");
+	printf("}\n");
+	printf("\nvoid llr_xorgf_acc_mul_diff(void* restrict acc, unsigned char c, void const* restrict a, void const* restrict b) {\n");
+	printf("\tllr_xorgf_acc_mul_diff_table[c](acc, a, b, slices_per_plane, 1);\n");
+	printf("}\n");
+	printf("\nvoid llr_xorgf_acc_mul_diff_slice(void* restrict acc, unsigned char c, void const* restrict a, void const* restrict b, unsigned int offset, unsigned int nbytes) {\n");
+	printf("\tllr_xorgf_acc_mul_diff_table[c]((unsigned char*) acc + offset,\n");
+	printf("\t\t\t\t\t(unsigned char const*) a + offset,\n");
+	printf("\t\t\t\t\t(unsigned char const*) b + offset,\n");
+	printf("\t\t\t\t\tnbytes / LLR_XORGF_SLICE_SIZE, 1);\n");
+	printf("}\n");
+
+	printf("\nint llr_xorgf_is_zero(void const* a) {\n");
+	printf("\treturn llr_xorgf_is_zero_impl(a, slices_per_plane);\n");
+	printf("}\n");
+	printf("\nint llr_xorgf_is_zero_slice(void const* a, unsigned int offset, unsigned int nbytes) {\n");
+	printf("\treturn llr_xorgf_is_zero_impl((unsigned char const*) a + offset,\n");
+	printf("\t\t\t\t      nbytes / LLR_XORGF_SLICE_SIZE);\n");
+	printf("}\n");
+
+	/* Gather the nonzero sources in batches; the first
+	 * batch sets dst, the later ones add to it.  */
+	printf("\nvoid llr_xorgf_xor_n(void* restrict dst, void const* const* srcs, unsigned int n) {\n");
+	printf("\tvoid const* batch[LLR_XORGF_XOR_MAX];\n");
+	printf("\tunsigned int i;\n");
+	printf("\tunsigned int count = 0;\n");
+	printf("\tint acc = 0;\n\n");
+	printf("\tfor (i = 0; i < n; ++i) {\n");
+	printf("\t\tif (!srcs[i] || llr_xorgf_is_zero(srcs[i]))\n");
+	printf("\t\t\tcontinue;\n");
+	printf("\t\tbatch[count++] = srcs[i];\n");
+	printf("\t\tif (count == LLR_XORGF_XOR_MAX) {\n");
+	printf("\t\t\tllr_xorgf_xor_table[acc][count - 1](dst, batch);\n");
+	printf("\t\t\tacc = 1;\n");
+	printf("\t\t\tcount = 0;\n");
+	printf("\t\t}\n");
+	printf("\t}\n");
+	printf("\tif (count != 0)\n");
+	printf("\t\tllr_xorgf_xor_table[acc][count - 1](dst, batch);\n");
+	printf("\telse if (!acc)\n");
+	printf("\t\tllr_memzero(dst, LLR_XORGF_BLOCK_SIZE);\n");
+	printf("}\n");
+	printf("\nvoid llr_xorgf_xor_batch(void* restrict dst, void const* const* srcs, unsigned int n, int acc) {\n");
+	printf("\tllr_xorgf_xor_table[acc != 0][n - 1](dst, srcs);\n");
+	printf("}\n");
+
+	/* Slice helpers.  */
+	printf("\nvoid llr_xorgf_copy_slice(void* restrict dst, void const* restrict src, unsigned int offset, unsigned int nbytes) {\n");
+	printf("\tunsigned int k;\n");
+	printf("\tfor (k = 0; k < 8; ++k) {\n");
+	printf("\t\tunsigned int at = k * (LLR_XORGF_BLOCK_SIZE / 8) + offset;\n");
+	printf("\t\tllr_memcpy((unsigned char*) dst + at, (unsigned char const*) src + at, nbytes);\n");
+	printf("\t}\n");
+	printf("}\n");
+	printf("\nvoid llr_xorgf_zero_slice(void* dst, unsigned int offset, unsigned int nbytes) {\n");
+	printf("\tunsigned int k;\n");
+	printf("\tfor (k = 0; k < 8; ++k) {\n");
+	printf("\t\tunsigned int at = k * (LLR_XORGF_BLOCK_SIZE / 8) + offset;\n");
+	printf("\t\tllr_memzero((unsigned char*) dst + at, nbytes);\n");
+	printf("\t}\n");
 	printf("}\n");
 }
 
 void generate_ones() {
-	unsigned int i, j, count;
-	uint64_t num;
+	unsigned int i;
+	cse_result cse;
 	printf("#include\"llr_xorgf_ones.h\"\n");
 	printf("\n");
 	printf("unsigned int const llr_xorgf_ones[256] = {\n");
 	for (i = 0; i < 256; ++i) {
-		count = 0;
-		num = all[i].num;
-		for (j = 0; j < 64; ++j) {
-			if ((num & 1) == 1)
-				++count;
-			num >>= 1;
-		}
-		printf("\t%u%s /* 0x%02x */\n", count, i == 255 ? "" : ",", i);
+		cse_compute(&cse, all[i]);
+		printf("\t%u%s /* 0x%02x */\n", cse_cost(&cse), i == 255 ? "" : ",", i);
 	}
 	printf("};\n");
 }
 
+static
+void usage(void) {
+	fprintf(stderr,
+		"Usage: llr_xorgf_generator ones\n"
+		"       llr_xorgf_generator [--unroll=N] [--prefetch=N] [--prefer-isa=NAME]\n");
+}
+
+/* Parse the tuning options; return false on error.  */
+static
+bool parse_options(int argc, char** argv) {
+	int i;
+	unsigned int j;
+
+	for (i = 1; i < argc; ++i) {
+		if (strncmp(argv[i], "--unroll=", 9) == 0) {
+			opt_unroll = (unsigned int) strtoul(argv[i] + 9, NULL, 10);
+			if (opt_unroll == 0)
+				return false;
+		} else if (strncmp(argv[i], "--prefetch=", 11) == 0) {
+			opt_prefetch = (unsigned int) strtoul(argv[i] + 11, NULL, 10);
+		} else if (strncmp(argv[i], "--prefer-isa=", 13) == 0) {
+			opt_prefer_isa = argv[i] + 13;
+			for (j = 0; j < NUM_ISA_VARIANTS; ++j) {
+				if (strcmp(opt_prefer_isa, isa_variants[j].name) == 0)
+					break;
+			}
+			if (j == NUM_ISA_VARIANTS)
+				return false;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
 int main(int argc, char** argv) {
 	unsigned int i;
 
 	all_init();
 
+	if (argc == 2 && strcmp(argv[1], "ones") == 0) {
+		printf("/* This file was generated by llr_xorgf_generator.  */\n");
+		print_license();
+		generate_ones();
+		return 0;
+	}
+	if (!parse_options(argc, argv)) {
+		usage();
+		return 1;
+	}
+
 	printf("/* This file was generated by llr_xorgf_generator.  */\n");
+	if (argc > 1) {
+		printf("/* Options:");
+		for (i = 1; i < (unsigned int) argc; ++i)
+			printf(" %s", argv[i]);
+		printf("  */\n");
+	}
 
 	print_license();
 
-	if (argc >= 2) {
-		generate_ones();
-		return 0;
+	printf("#include\"llr_util.h\"\n#include\"llr_xorgf.h\"\n#include<stdint.h>\n#include<string.h>\n\n");
+	/* Build several variants and select at runtime, unless
+	 * the unit type was fixed at configure time, the
+	 * compiler or processor does not support it, or this is
+	 * a kernel build, which must not touch the SIMD state
+	 * outside kernel_fpu_begin/end.  */
+	printf("#if !defined(LLR_XORGF_NO_DISPATCH) && !defined(__KERNEL__) && \\\n");
+	printf("    !defined(LLR_XORGF_UNIT_TYPE) && !defined(LLR_XORGF_VECTOR_SIZE) && \\\n");
+	printf("    defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))\n");
+	printf("# define LLR_XORGF_DISPATCH 1\n");
+	printf("#endif\n\n");
+	/* Tuning helpers for the unrolled kernels.  */
+	if (opt_unroll > 1) {
+		printf("#if defined(__clang__)\n");
+		printf("# define LLR_XORGF_UNROLL _Pragma(\"unroll %u\")\n", opt_unroll);
+		printf("#elif defined(__GNUC__)\n");
+		printf("# define LLR_XORGF_UNROLL _Pragma(\"GCC unroll %u\")\n", opt_unroll);
+		printf("#else\n");
+		printf("# define LLR_XORGF_UNROLL\n");
+		printf("#endif\n");
 	}
-
-	printf("#include\"llr_xorgf.h\"\n#include<stdint.h>\n#include<string.h>\n\n");
+	if (opt_prefetch != 0) {
+		printf("#if defined(__GNUC__)\n");
+		printf("# define LLR_XORGF_PREFETCH(p) __builtin_prefetch(p)\n");
+		printf("#else\n");
+		printf("# define LLR_XORGF_PREFETCH(p) ((void) 0)\n");
+		printf("#endif\n");
+	}
+	if (opt_unroll > 1 || opt_prefetch != 0)
+		printf("\n");
 	/* Support completely overriding the unit_type.   */
 	printf("#if defined(LLR_XORGF_UNIT_TYPE)\n");
-	printf("typedef LLR_XORGF_UNIT_TYPE unit_type;\n");
+	printf("typedef LLR_XORGF_UNIT_TYPE llr_xorgf_unit_generic;\n");
 	printf("#else /* defined(LLR_XORGF_UNIT_TYPE) */ \n");
 	/* uint_fast32_5 should be a 32-bit word for 32-bit processors, a
 	 * 64-bit word for 64-bit processors.  */
-	printf("typedef uint_fast32_t unit_type\n");
+	printf("typedef uint_fast32_t llr_xorgf_unit_generic\n");
 	/* Support adding __attribute__((vector_size(x))).  */
 	printf("#if defined(LLR_XORGF_VECTOR_SIZE)\n");
 	printf("\t__attribute__((vector_size(LLR_XORGF_VECTOR_SIZE)))\n");
@@ -342,12 +1081,34 @@ int main(int argc, char** argv) {
 	printf(";\n");
 	printf("#endif /* !defined(LLR_XORGF_UNIT_TYPE)*/ \n");
 	printf("\n");
-	printf("static unsigned int const span = (LLR_XORGF_BLOCK_SIZE / 8) / sizeof(unit_type);\n\n");
+	/* These depend on unit_type, which each variant defines.  */
+	printf("#define span ((unsigned int) ((LLR_XORGF_BLOCK_SIZE / 8) / sizeof(unit_type)))\n");
+	printf("#define slice_span ((unsigned int) (LLR_XORGF_SLICE_SIZE / sizeof(unit_type)))\n");
+	printf("static unsigned int const slices_per_plane = (LLR_XORGF_BLOCK_SIZE / 8) / LLR_XORGF_SLICE_SIZE;\n\n");
+	printf("typedef void (*llr_xorgf_acc_mul_func)(void* restrict acc, void const* restrict a, unsigned int nslices, unsigned int nblocks);\n");
+	printf("typedef void (*llr_xorgf_acc_mul_diff_func)(void* restrict acc, void const* restrict a, void const* restrict b, unsigned int nslices, unsigned int nblocks);\n");
+	printf("typedef void (*llr_xorgf_xor_func)(void* restrict dst, void const* const* srcs);\n");
+	printf("typedef int (*llr_xorgf_is_zero_func)(void const* a, unsigned int nslices);\n");
+	printf("typedef void (*llr_xorgf_acc_mul_row_func)(void* restrict acc, void const* const* srcs, unsigned int nslices);\n");
+	/* The tables below are sized by the header.  */
+	printf("typedef char llr_xorgf_xor_max_check[(LLR_XORGF_XOR_MAX == %u) ? 1 : -1];\n\n",
+	       XOR_MAX);
 
 	for (i = 2; i < 256; ++i)
 		make_mul_macro(i);
 
-	make_acc_mul();
+	/* Keep the compact kernels out of line.  */
+	printf("#if defined(__GNUC__)\n");
+	printf("# define LLR_XORGF_NOINLINE __attribute__((noinline))\n");
+	printf("#else\n");
+	printf("# define LLR_XORGF_NOINLINE\n");
+	printf("#endif\n\n");
+	make_rowmasks();
+
+	for (i = 0; i < NUM_ISA_VARIANTS; ++i)
+		make_variant(&isa_variants[i]);
+
+	make_dispatch();
 
 	return 0;
 }
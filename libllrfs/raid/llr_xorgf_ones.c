@@ -30,257 +30,257 @@ unsigned int const llr_xorgf_ones[256] = {
 	0, /* 0x00 */
 	8, /* 0x01 */
 	11, /* 0x02 */
-	19, /* 0x03 */
-	14, /* 0x04 */
-	22, /* 0x05 */
-	21, /* 0x06 */
-	29, /* 0x07 */
-	17, /* 0x08 */
-	25, /* 0x09 */
-	24, /* 0x0a */
-	32, /* 0x0b */
-	23, /* 0x0c */
-	31, /* 0x0d */
-	30, /* 0x0e */
-	38, /* 0x0f */
-	20, /* 0x10 */
+	18, /* 0x03 */
+	13, /* 0x04 */
+	18, /* 0x05 */
+	19, /* 0x06 */
+	22, /* 0x07 */
+	16, /* 0x08 */
+	21, /* 0x09 */
+	19, /* 0x0a */
+	25, /* 0x0b */
+	21, /* 0x0c */
+	26, /* 0x0d */
+	25, /* 0x0e */
+	26, /* 0x0f */
+	18, /* 0x10 */
 	20, /* 0x11 */
-	29, /* 0x12 */
-	29, /* 0x13 */
-	26, /* 0x14 */
-	26, /* 0x15 */
-	35, /* 0x16 */
-	35, /* 0x17 */
-	25, /* 0x18 */
-	25, /* 0x19 */
-	30, /* 0x1a */
-	30, /* 0x1b */
-	31, /* 0x1c */
-	31, /* 0x1d */
-	40, /* 0x1e */
-	40, /* 0x1f */
-	24, /* 0x20 */
-	22, /* 0x21 */
+	21, /* 0x12 */
+	22, /* 0x13 */
+	20, /* 0x14 */
+	22, /* 0x15 */
+	25, /* 0x16 */
+	25, /* 0x17 */
+	20, /* 0x18 */
+	23, /* 0x19 */
+	25, /* 0x1a */
+	24, /* 0x1b */
+	24, /* 0x1c */
+	26, /* 0x1d */
+	26, /* 0x1e */
+	27, /* 0x1f */
+	20, /* 0x20 */
+	20, /* 0x21 */
 	21, /* 0x22 */
 	19, /* 0x23 */
-	34, /* 0x24 */
-	32, /* 0x25 */
-	31, /* 0x26 */
-	29, /* 0x27 */
-	29, /* 0x28 */
-	27, /* 0x29 */
-	26, /* 0x2a */
-	24, /* 0x2b */
-	35, /* 0x2c */
-	33, /* 0x2d */
-	36, /* 0x2e */
-	34, /* 0x2f */
-	26, /* 0x30 */
-	32, /* 0x31 */
-	25, /* 0x32 */
-	31, /* 0x33 */
-	32, /* 0x34 */
-	38, /* 0x35 */
-	27, /* 0x36 */
-	33, /* 0x37 */
-	31, /* 0x38 */
-	37, /* 0x39 */
-	30, /* 0x3a */
-	36, /* 0x3b */
-	41, /* 0x3c */
-	47, /* 0x3d */
-	40, /* 0x3e */
-	46, /* 0x3f */
-	27, /* 0x40 */
-	23, /* 0x41 */
-	24, /* 0x42 */
+	21, /* 0x24 */
+	19, /* 0x25 */
+	23, /* 0x26 */
+	19, /* 0x27 */
+	22, /* 0x28 */
+	22, /* 0x29 */
+	22, /* 0x2a */
+	21, /* 0x2b */
+	25, /* 0x2c */
+	26, /* 0x2d */
+	25, /* 0x2e */
+	24, /* 0x2f */
+	20, /* 0x30 */
+	23, /* 0x31 */
+	21, /* 0x32 */
+	25, /* 0x33 */
+	26, /* 0x34 */
+	25, /* 0x35 */
+	22, /* 0x36 */
+	25, /* 0x37 */
+	22, /* 0x38 */
+	25, /* 0x39 */
+	25, /* 0x3a */
+	23, /* 0x3b */
+	27, /* 0x3c */
+	25, /* 0x3d */
+	28, /* 0x3e */
+	28, /* 0x3f */
+	22, /* 0x40 */
+	22, /* 0x41 */
+	22, /* 0x42 */
 	20, /* 0x43 */
-	25, /* 0x44 */
-	21, /* 0x45 */
+	22, /* 0x44 */
+	20, /* 0x45 */
 	18, /* 0x46 */
-	14, /* 0x47 */
-	38, /* 0x48 */
-	34, /* 0x49 */
-	35, /* 0x4a */
-	31, /* 0x4b */
-	32, /* 0x4c */
-	28, /* 0x4d */
-	29, /* 0x4e */
-	25, /* 0x4f */
-	33, /* 0x50 */
-	37, /* 0x51 */
-	28, /* 0x52 */
-	32, /* 0x53 */
-	27, /* 0x54 */
-	31, /* 0x55 */
-	22, /* 0x56 */
-	26, /* 0x57 */
-	36, /* 0x58 */
-	40, /* 0x59 */
-	31, /* 0x5a */
-	35, /* 0x5b */
-	34, /* 0x5c */
-	38, /* 0x5d */
-	33, /* 0x5e */
-	37, /* 0x5f */
-	27, /* 0x60 */
-	33, /* 0x61 */
-	34, /* 0x62 */
-	40, /* 0x63 */
-	25, /* 0x64 */
-	31, /* 0x65 */
-	32, /* 0x66 */
-	38, /* 0x67 */
-	34, /* 0x68 */
-	40, /* 0x69 */
-	37, /* 0x6a */
-	43, /* 0x6b */
-	24, /* 0x6c */
-	30, /* 0x6d */
-	31, /* 0x6e */
-	37, /* 0x6f */
-	31, /* 0x70 */
-	29, /* 0x71 */
-	40, /* 0x72 */
-	38, /* 0x73 */
-	29, /* 0x74 */
-	27, /* 0x75 */
-	34, /* 0x76 */
-	32, /* 0x77 */
-	42, /* 0x78 */
-	40, /* 0x79 */
-	47, /* 0x7a */
-	45, /* 0x7b */
-	40, /* 0x7c */
-	38, /* 0x7d */
-	45, /* 0x7e */
-	43, /* 0x7f */
-	29, /* 0x80 */
-	37, /* 0x81 */
-	24, /* 0x82 */
-	32, /* 0x83 */
-	25, /* 0x84 */
-	33, /* 0x85 */
+	13, /* 0x47 */
+	23, /* 0x48 */
+	24, /* 0x49 */
+	20, /* 0x4a */
+	23, /* 0x4b */
+	24, /* 0x4c */
+	23, /* 0x4d */
+	19, /* 0x4e */
+	21, /* 0x4f */
+	23, /* 0x50 */
+	20, /* 0x51 */
+	23, /* 0x52 */
+	18, /* 0x53 */
+	21, /* 0x54 */
+	24, /* 0x55 */
+	18, /* 0x56 */
+	23, /* 0x57 */
+	26, /* 0x58 */
+	23, /* 0x59 */
+	24, /* 0x5a */
+	23, /* 0x5b */
+	23, /* 0x5c */
+	26, /* 0x5d */
+	23, /* 0x5e */
+	24, /* 0x5f */
+	20, /* 0x60 */
+	24, /* 0x61 */
+	24, /* 0x62 */
+	25, /* 0x63 */
+	21, /* 0x64 */
+	25, /* 0x65 */
+	25, /* 0x66 */
+	26, /* 0x67 */
+	27, /* 0x68 */
+	25, /* 0x69 */
+	26, /* 0x6a */
+	25, /* 0x6b */
+	20, /* 0x6c */
+	22, /* 0x6d */
+	25, /* 0x6e */
+	25, /* 0x6f */
+	21, /* 0x70 */
+	23, /* 0x71 */
+	23, /* 0x72 */
+	23, /* 0x73 */
+	24, /* 0x74 */
+	23, /* 0x75 */
+	22, /* 0x76 */
+	23, /* 0x77 */
+	28, /* 0x78 */
+	26, /* 0x79 */
+	23, /* 0x7a */
+	25, /* 0x7b */
+	26, /* 0x7c */
+	27, /* 0x7d */
+	28, /* 0x7e */
+	27, /* 0x7f */
+	24, /* 0x80 */
+	24, /* 0x81 */
+	22, /* 0x82 */
+	26, /* 0x83 */
+	22, /* 0x84 */
+	25, /* 0x85 */
 	20, /* 0x86 */
-	28, /* 0x87 */
-	28, /* 0x88 */
-	36, /* 0x89 */
-	23, /* 0x8a */
-	31, /* 0x8b */
-	20, /* 0x8c */
-	28, /* 0x8d */
+	24, /* 0x87 */
+	23, /* 0x88 */
+	25, /* 0x89 */
+	21, /* 0x8a */
+	24, /* 0x8b */
+	18, /* 0x8c */
+	22, /* 0x8d */
 	11, /* 0x8e */
-	19, /* 0x8f */
-	43, /* 0x90 */
-	43, /* 0x91 */
-	36, /* 0x92 */
-	36, /* 0x93 */
-	35, /* 0x94 */
-	35, /* 0x95 */
-	32, /* 0x96 */
-	32, /* 0x97 */
-	34, /* 0x98 */
-	34, /* 0x99 */
-	27, /* 0x9a */
-	27, /* 0x9b */
-	30, /* 0x9c */
-	30, /* 0x9d */
-	23, /* 0x9e */
-	23, /* 0x9f */
-	37, /* 0xa0 */
-	35, /* 0xa1 */
-	38, /* 0xa2 */
-	36, /* 0xa3 */
-	29, /* 0xa4 */
-	27, /* 0xa5 */
-	34, /* 0xa6 */
-	32, /* 0xa7 */
-	28, /* 0xa8 */
-	26, /* 0xa9 */
-	33, /* 0xaa */
-	31, /* 0xab */
-	20, /* 0xac */
-	18, /* 0xad */
-	25, /* 0xae */
-	23, /* 0xaf */
-	37, /* 0xb0 */
-	43, /* 0xb1 */
-	40, /* 0xb2 */
-	46, /* 0xb3 */
-	29, /* 0xb4 */
-	35, /* 0xb5 */
-	32, /* 0xb6 */
-	38, /* 0xb7 */
-	32, /* 0xb8 */
-	38, /* 0xb9 */
-	39, /* 0xba */
-	45, /* 0xbb */
-	32, /* 0xbc */
-	38, /* 0xbd */
-	35, /* 0xbe */
-	41, /* 0xbf */
-	28, /* 0xc0 */
-	24, /* 0xc1 */
-	33, /* 0xc2 */
-	29, /* 0xc3 */
-	36, /* 0xc4 */
-	32, /* 0xc5 */
-	41, /* 0xc6 */
-	37, /* 0xc7 */
-	25, /* 0xc8 */
-	21, /* 0xc9 */
-	34, /* 0xca */
-	30, /* 0xcb */
-	33, /* 0xcc */
-	29, /* 0xcd */
-	38, /* 0xce */
-	34, /* 0xcf */
-	36, /* 0xd0 */
-	40, /* 0xd1 */
-	39, /* 0xd2 */
-	43, /* 0xd3 */
-	36, /* 0xd4 */
-	40, /* 0xd5 */
-	43, /* 0xd6 */
-	47, /* 0xd7 */
-	21, /* 0xd8 */
-	25, /* 0xd9 */
-	28, /* 0xda */
-	32, /* 0xdb */
-	29, /* 0xdc */
-	33, /* 0xdd */
-	36, /* 0xde */
-	40, /* 0xdf */
-	32, /* 0xe0 */
-	38, /* 0xe1 */
-	27, /* 0xe2 */
-	33, /* 0xe3 */
-	40, /* 0xe4 */
-	46, /* 0xe5 */
-	39, /* 0xe6 */
-	45, /* 0xe7 */
-	29, /* 0xe8 */
-	35, /* 0xe9 */
-	24, /* 0xea */
-	30, /* 0xeb */
-	33, /* 0xec */
-	39, /* 0xed */
-	28, /* 0xee */
-	34, /* 0xef */
-	42, /* 0xf0 */
-	40, /* 0xf1 */
-	39, /* 0xf2 */
-	37, /* 0xf3 */
-	46, /* 0xf4 */
-	44, /* 0xf5 */
-	43, /* 0xf6 */
-	41, /* 0xf7 */
-	39, /* 0xf8 */
-	37, /* 0xf9 */
-	36, /* 0xfa */
-	34, /* 0xfb */
-	47, /* 0xfc */
-	45, /* 0xfd */
-	40, /* 0xfe */
-	38 /* 0xff */
+	17, /* 0x8f */
+	23, /* 0x90 */
+	26, /* 0x91 */
+	23, /* 0x92 */
+	22, /* 0x93 */
+	22, /* 0x94 */
+	26, /* 0x95 */
+	23, /* 0x96 */
+	23, /* 0x97 */
+	26, /* 0x98 */
+	25, /* 0x99 */
+	22, /* 0x9a */
+	21, /* 0x9b */
+	19, /* 0x9c */
+	19, /* 0x9d */
+	20, /* 0x9e */
+	20, /* 0x9f */
+	25, /* 0xa0 */
+	24, /* 0xa1 */
+	21, /* 0xa2 */
+	23, /* 0xa3 */
+	24, /* 0xa4 */
+	22, /* 0xa5 */
+	18, /* 0xa6 */
+	18, /* 0xa7 */
+	22, /* 0xa8 */
+	22, /* 0xa9 */
+	25, /* 0xaa */
+	24, /* 0xab */
+	18, /* 0xac */
+	16, /* 0xad */
+	21, /* 0xae */
+	20, /* 0xaf */
+	27, /* 0xb0 */
+	25, /* 0xb1 */
+	25, /* 0xb2 */
+	27, /* 0xb3 */
+	23, /* 0xb4 */
+	25, /* 0xb5 */
+	23, /* 0xb6 */
+	22, /* 0xb7 */
+	23, /* 0xb8 */
+	25, /* 0xb9 */
+	26, /* 0xba */
+	28, /* 0xbb */
+	24, /* 0xbc */
+	27, /* 0xbd */
+	24, /* 0xbe */
+	26, /* 0xbf */
+	19, /* 0xc0 */
+	21, /* 0xc1 */
+	25, /* 0xc2 */
+	24, /* 0xc3 */
+	24, /* 0xc4 */
+	22, /* 0xc5 */
+	24, /* 0xc6 */
+	22, /* 0xc7 */
+	21, /* 0xc8 */
+	18, /* 0xc9 */
+	24, /* 0xca */
+	22, /* 0xcb */
+	25, /* 0xcc */
+	23, /* 0xcd */
+	26, /* 0xce */
+	26, /* 0xcf */
+	26, /* 0xd0 */
+	25, /* 0xd1 */
+	25, /* 0xd2 */
+	27, /* 0xd3 */
+	26, /* 0xd4 */
+	23, /* 0xd5 */
+	25, /* 0xd6 */
+	27, /* 0xd7 */
+	18, /* 0xd8 */
+	21, /* 0xd9 */
+	23, /* 0xda */
+	24, /* 0xdb */
+	25, /* 0xdc */
+	19, /* 0xdd */
+	25, /* 0xde */
+	24, /* 0xdf */
+	19, /* 0xe0 */
+	24, /* 0xe1 */
+	23, /* 0xe2 */
+	26, /* 0xe3 */
+	23, /* 0xe4 */
+	25, /* 0xe5 */
+	24, /* 0xe6 */
+	28, /* 0xe7 */
+	24, /* 0xe8 */
+	26, /* 0xe9 */
+	20, /* 0xea */
+	21, /* 0xeb */
+	22, /* 0xec */
+	23, /* 0xed */
+	23, /* 0xee */
+	25, /* 0xef */
+	28, /* 0xf0 */
+	26, /* 0xf1 */
+	28, /* 0xf2 */
+	22, /* 0xf3 */
+	21, /* 0xf4 */
+	21, /* 0xf5 */
+	25, /* 0xf6 */
+	21, /* 0xf7 */
+	24, /* 0xf8 */
+	27, /* 0xf9 */
+	24, /* 0xfa */
+	20, /* 0xfb */
+	27, /* 0xfc */
+	27, /* 0xfd */
+	26, /* 0xfe */
+	24 /* 0xff */
 };
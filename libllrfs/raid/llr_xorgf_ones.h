@@ -27,18 +27,24 @@ SOFTWARE.
 #endif
 
 /*
-This module provides the number of ones in the bit
-matrix for each GF(2^8) element.
+This module provides the number of XORs needed to
+multiply-accumulate by each GF(2^8) element.
 This serves as the cost of multiplying a block by
 that element, and is used to reduce the cost for the
 generated Cauchy matrix.
+
+The name is historical: the cost used to be the number
+of ones in the bit matrix for the element.
+The generated multipliers now share common pairs of
+inputs between rows of the matrix, so the cost is
+usually lower than that.
 */
 
 /** llr_xorgf_ones
  *
  * @brief For each GF(2^8) element, indicates the
- * number of ones in the equivalent bit matrix for
- * that element.
+ * number of XORs the generated multiplier for that
+ * element performs per unit of each plane.
  */
 extern unsigned int const llr_xorgf_ones[256];
 
@@ -0,0 +1,168 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#undef NDEBUG
+#include"raid/llr_batch.h"
+#include"raid/llr_decoder.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_batch_pthread.h"
+#include"userspace/llr_testvectors.h"
+#include<assert.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This test checks that batches give exactly the same results
+as encoding or decoding each stripe serially.
+*/
+
+#define NUM_STRIPES 37
+#define NUM_DATA 8
+#define NUM_PARITY 3
+#define NUM_LOST 2
+
+static unsigned char* data;
+static unsigned char* parity;
+static unsigned char* serial_parity;
+
+static void const* data_blocks[NUM_STRIPES][NUM_DATA];
+static void* parity_blocks[NUM_STRIPES][NUM_PARITY];
+
+static unsigned char*
+block(unsigned char* base, unsigned int stripe, unsigned int n, unsigned int i) {
+	return &base[(stripe * n + i) * LLR_XORGF_BLOCK_SIZE];
+}
+
+/* Runs the workers one after the other, last first, so
+ * that the last worker has to steal everything.  */
+static void
+reverse_run(void* ctx, unsigned int num_workers,
+	    llr_batch_worker_func func, void* arg) {
+	unsigned int w;
+	(void) ctx;
+	for (w = num_workers; w > 0; --w)
+		func(arg, w - 1);
+}
+
+static void
+test_encode(struct llr_batch_host const* host, unsigned int min_steals) {
+	struct llr_batch_encode_stripe stripes[NUM_STRIPES];
+	struct llr_batch_stats stats;
+	unsigned int s;
+
+	for (s = 0; s < NUM_STRIPES; ++s) {
+		stripes[s].data_blocks = data_blocks[s];
+		stripes[s].parity_blocks = parity_blocks[s];
+	}
+
+	memset(parity, 0xA5, NUM_STRIPES * NUM_PARITY * LLR_XORGF_BLOCK_SIZE);
+	llr_batch_encode(host, stripes, NUM_STRIPES, NUM_DATA, NUM_PARITY,
+			 &stats);
+	assert(0 == memcmp(parity, serial_parity,
+			   NUM_STRIPES * NUM_PARITY * LLR_XORGF_BLOCK_SIZE));
+	assert(stats.bytes ==
+	       (unsigned long long) NUM_STRIPES * NUM_DATA * LLR_XORGF_BLOCK_SIZE);
+	assert(stats.steals >= min_steals);
+}
+
+static void
+test_decode(struct llr_batch_host const* host) {
+	unsigned int const lost_data[NUM_LOST] = { 2, 5 };
+	unsigned int matrix_storage_size, scratch_space_size;
+	unsigned char* matrix_storage;
+	unsigned char* scratch_space;
+	llr_decoder decoder;
+
+	struct llr_batch_decode_stripe stripes[NUM_STRIPES];
+	void const* remaining_blocks[NUM_STRIPES][NUM_DATA + NUM_PARITY];
+	void* recovered_blocks[NUM_STRIPES][NUM_LOST];
+	unsigned char* recovered;
+	struct llr_batch_stats stats;
+	unsigned int s, i, n;
+
+	llr_decoder_sizes(&matrix_storage_size, &scratch_space_size,
+			  NUM_DATA, NUM_PARITY,
+			  lost_data, NUM_LOST, NULL, 0);
+	matrix_storage = malloc(matrix_storage_size);
+	scratch_space = malloc(scratch_space_size);
+	llr_decoder_init(&decoder, NUM_DATA, NUM_PARITY,
+			 lost_data, NUM_LOST, NULL, 0,
+			 matrix_storage, scratch_space);
+
+	recovered = malloc(NUM_STRIPES * NUM_LOST * LLR_XORGF_BLOCK_SIZE);
+	for (s = 0; s < NUM_STRIPES; ++s) {
+		n = 0;
+		for (i = 0; i < NUM_DATA; ++i) {
+			if (i != lost_data[0] && i != lost_data[1])
+				remaining_blocks[s][n++] = data_blocks[s][i];
+		}
+		for (i = 0; i < NUM_PARITY; ++i)
+			remaining_blocks[s][n++] = parity_blocks[s][i];
+		for (i = 0; i < NUM_LOST; ++i)
+			recovered_blocks[s][i] = block(recovered, s, NUM_LOST, i);
+		stripes[s].lost_data_blocks = recovered_blocks[s];
+		stripes[s].remaining_blocks = remaining_blocks[s];
+	}
+
+	llr_batch_decode(host, &decoder, stripes, NUM_STRIPES, &stats);
+	for (s = 0; s < NUM_STRIPES; ++s) {
+		for (i = 0; i < NUM_LOST; ++i)
+			assert(0 == memcmp(recovered_blocks[s][i],
+					   data_blocks[s][lost_data[i]],
+					   LLR_XORGF_BLOCK_SIZE));
+	}
+	assert(stats.bytes ==
+	       (unsigned long long) NUM_STRIPES * NUM_LOST * LLR_XORGF_BLOCK_SIZE);
+
+	free(recovered);
+	free(scratch_space);
+	free(matrix_storage);
+}
+
+int main(void) {
+	struct llr_batch_host host;
+	unsigned int s, i;
+
+	data = malloc(NUM_STRIPES * NUM_DATA * LLR_XORGF_BLOCK_SIZE);
+	parity = malloc(NUM_STRIPES * NUM_PARITY * LLR_XORGF_BLOCK_SIZE);
+	serial_parity = malloc(NUM_STRIPES * NUM_PARITY * LLR_XORGF_BLOCK_SIZE);
+
+	/* Give each stripe different data, and encode serially
+	 * for reference.  */
+	for (s = 0; s < NUM_STRIPES; ++s) {
+		void* serial_blocks[NUM_PARITY];
+		for (i = 0; i < NUM_DATA; ++i) {
+			memcpy(block(data, s, NUM_DATA, i),
+			       llr_testvectors_sampledata[(s + i) % 8],
+			       LLR_XORGF_BLOCK_SIZE);
+			block(data, s, NUM_DATA, i)[s] ^= 0xFF;
+			data_blocks[s][i] = block(data, s, NUM_DATA, i);
+		}
+		for (i = 0; i < NUM_PARITY; ++i) {
+			parity_blocks[s][i] = block(parity, s, NUM_PARITY, i);
+			serial_blocks[i] = block(serial_parity, s, NUM_PARITY, i);
+		}
+		llr_encode(data_blocks[s], NUM_DATA, serial_blocks, NUM_PARITY);
+	}
+
+	/* Real threads.  */
+	for (i = 1; i <= 5; ++i) {
+		llr_batch_pthread_host(&host, i);
+		test_encode(&host, 0);
+		test_decode(&host);
+	}
+
+	/* Workers that start late must steal.  */
+	host.run = &reverse_run;
+	host.now_ns = NULL;
+	host.ctx = NULL;
+	host.num_workers = 4;
+	test_encode(&host, 1);
+	test_decode(&host);
+
+	free(serial_parity);
+	free(parity);
+	free(data);
+	return 0;
+}
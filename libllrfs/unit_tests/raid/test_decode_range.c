@@ -0,0 +1,126 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#undef NDEBUG
+#include"raid/llr_decoder.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<assert.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This test checks that ranged decoding matches the same
+bytes of a full decode, and leaves the rest of the lost
+blocks alone.
+*/
+
+#define MAX_DATA 10
+#define MAX_PARITY 4
+
+static void const* data_blocks[MAX_DATA];
+static void* parity_blocks[MAX_PARITY];
+static void* full_blocks[MAX_PARITY];
+static void* range_blocks[MAX_PARITY];
+
+static void
+test_decode_range(unsigned int num_data_blocks, unsigned int num_parity_blocks,
+		  unsigned int const* lost_data, unsigned int num_lost_data) {
+	static unsigned int const ranges[][2] = {
+		/* Within one plane.  */
+		{0, LLR_XORGF_SLICE_SIZE},
+		{3 * LLR_XORGF_SLICE_SIZE, 2 * LLR_XORGF_SLICE_SIZE},
+		/* Across planes.  */
+		{LLR_XORGF_BLOCK_SIZE / 8 - LLR_XORGF_SLICE_SIZE,
+		 3 * LLR_XORGF_SLICE_SIZE},
+		{LLR_XORGF_BLOCK_SIZE - LLR_XORGF_SLICE_SIZE, LLR_XORGF_SLICE_SIZE},
+		/* Everything.  */
+		{0, LLR_XORGF_BLOCK_SIZE}
+	};
+	void const* remaining_blocks[MAX_DATA + MAX_PARITY];
+	unsigned char* matrix_storage;
+	unsigned char* scratch_space;
+	unsigned int matrix_storage_size, scratch_space_size;
+	llr_decoder decoder;
+	unsigned int i, j, l, r, p;
+
+	for (i = 0; i < num_data_blocks; ++i)
+		data_blocks[i] = llr_testvectors_sampledata[(i * 3) % 8];
+	llr_encode(data_blocks, num_data_blocks,
+		   parity_blocks, num_parity_blocks);
+
+	r = 0;
+	for (i = 0, l = 0; i < num_data_blocks; ++i) {
+		if (l < num_lost_data && lost_data[l] == i)
+			++l;
+		else
+			remaining_blocks[r++] = data_blocks[i];
+	}
+	for (j = 0; j < num_parity_blocks; ++j)
+		remaining_blocks[r++] = parity_blocks[j];
+
+	llr_decoder_sizes(&matrix_storage_size, &scratch_space_size,
+			  num_data_blocks, num_parity_blocks,
+			  lost_data, num_lost_data, NULL, 0);
+	matrix_storage = malloc(matrix_storage_size + 1);
+	scratch_space = malloc(scratch_space_size + 1);
+	llr_decoder_init(&decoder, num_data_blocks, num_parity_blocks,
+			 lost_data, num_lost_data, NULL, 0,
+			 matrix_storage, scratch_space);
+	llr_decoder_decode(&decoder, full_blocks, remaining_blocks);
+
+	for (i = 0; i < sizeof(ranges) / sizeof(ranges[0]); ++i) {
+		unsigned int offset = ranges[i][0];
+		unsigned int nbytes = ranges[i][1];
+
+		for (l = 0; l < num_lost_data; ++l)
+			memset(range_blocks[l], 0x5A, LLR_XORGF_BLOCK_SIZE);
+		llr_decoder_decode_range(&decoder, range_blocks,
+					 remaining_blocks, offset, nbytes);
+		for (l = 0; l < num_lost_data; ++l) {
+			unsigned char const* full = full_blocks[l];
+			unsigned char const* part = range_blocks[l];
+			assert(0 == memcmp(full, data_blocks[lost_data[l]],
+					   LLR_XORGF_BLOCK_SIZE));
+			for (p = 0; p < LLR_XORGF_BLOCK_SIZE; ++p) {
+				if (p >= offset && p < offset + nbytes)
+					assert(part[p] == full[p]);
+				else
+					assert(part[p] == 0x5A);
+			}
+		}
+	}
+
+	free(scratch_space);
+	free(matrix_storage);
+}
+
+int main(void) {
+	static unsigned int const lost_0[] = { 0 };
+	static unsigned int const lost_4[] = { 4 };
+	static unsigned int const lost_1_6[] = { 1, 6 };
+	static unsigned int const lost_0_2_9[] = { 0, 2, 9 };
+	unsigned int j;
+
+	for (j = 0; j < MAX_PARITY; ++j) {
+		parity_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+		full_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+		range_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+	}
+
+	/* Mirroring.  */
+	test_decode_range(1, 2, lost_0, 1);
+	/* RAID5.  */
+	test_decode_range(MAX_DATA, 1, lost_4, 1);
+	/* Multiplication by a matrix.  */
+	test_decode_range(MAX_DATA, MAX_PARITY, lost_1_6, 2);
+	test_decode_range(MAX_DATA, MAX_PARITY, lost_0_2_9, 3);
+
+	for (j = 0; j < MAX_PARITY; ++j) {
+		free(range_blocks[j]);
+		free(full_blocks[j]);
+		free(parity_blocks[j]);
+	}
+	return 0;
+}
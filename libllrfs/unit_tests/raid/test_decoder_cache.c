@@ -0,0 +1,119 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#undef NDEBUG
+#include"raid/llr_decoder_cache.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<assert.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This test checks that decoders from the cache recover the
+lost data, and that the cache evicts the least recently
+used decoder.
+*/
+
+#define NUM_DATA 16
+#define NUM_PARITY 4
+
+static void const* data_blocks[NUM_DATA];
+static void* parity_blocks[NUM_PARITY];
+static void* recovered_blocks[NUM_PARITY];
+
+struct pattern {
+	unsigned int lost_data[NUM_PARITY];
+	unsigned int num_lost_data;
+	unsigned int lost_parity[NUM_PARITY];
+	unsigned int num_lost_parity;
+};
+
+static struct pattern const patterns[] = {
+	{ { 0, 5, 9, 15 }, 4, { 0 }, 0 },
+	{ { 3, 4 }, 2, { 0, 2 }, 2 },
+	{ { 7 }, 1, { 1 }, 1 }
+};
+
+static llr_decoder const*
+get_and_check(llr_decoder_cache* cache, unsigned int p) {
+	struct pattern const* pat = &patterns[p];
+	void const* remaining_blocks[NUM_DATA + NUM_PARITY];
+	unsigned int i, j, n;
+	llr_decoder const* decoder;
+
+	decoder = llr_decoder_cache_get(cache, NUM_DATA, NUM_PARITY,
+					pat->lost_data, pat->num_lost_data,
+					pat->lost_parity, pat->num_lost_parity);
+
+	n = 0;
+	for (i = 0, j = 0; i < NUM_DATA; ++i) {
+		if (j < pat->num_lost_data && pat->lost_data[j] == i) {
+			++j;
+			continue;
+		}
+		remaining_blocks[n++] = data_blocks[i];
+	}
+	for (i = 0, j = 0; i < NUM_PARITY; ++i) {
+		if (j < pat->num_lost_parity && pat->lost_parity[j] == i) {
+			++j;
+			continue;
+		}
+		remaining_blocks[n++] = parity_blocks[i];
+	}
+
+	for (i = 0; i < pat->num_lost_data; ++i)
+		memset(recovered_blocks[i], 0xA5, LLR_XORGF_BLOCK_SIZE);
+	llr_decoder_decode(decoder, recovered_blocks, remaining_blocks);
+	for (i = 0; i < pat->num_lost_data; ++i)
+		assert(0 == memcmp(recovered_blocks[i],
+				   data_blocks[pat->lost_data[i]],
+				   LLR_XORGF_BLOCK_SIZE));
+
+	return decoder;
+}
+
+int main(void) {
+	unsigned int i;
+	llr_decoder_cache cache;
+	void* storage;
+	llr_decoder const* decoder0;
+
+	for (i = 0; i < NUM_DATA; ++i)
+		data_blocks[i] = llr_testvectors_sampledata[i % 8];
+	for (i = 0; i < NUM_PARITY; ++i) {
+		parity_blocks[i] = malloc(LLR_XORGF_BLOCK_SIZE);
+		recovered_blocks[i] = malloc(LLR_XORGF_BLOCK_SIZE);
+	}
+	llr_encode(data_blocks, NUM_DATA, parity_blocks, NUM_PARITY);
+
+	/* Room for only two decoders.  */
+	storage = malloc(llr_decoder_cache_size(2, NUM_DATA));
+	llr_decoder_cache_init(&cache, 2, NUM_DATA, storage);
+
+	decoder0 = get_and_check(&cache, 0);
+	assert(cache.hits == 0 && cache.misses == 1);
+	get_and_check(&cache, 1);
+	assert(cache.hits == 0 && cache.misses == 2);
+
+	/* Hit, and the same decoder is returned.  */
+	assert(get_and_check(&cache, 0) == decoder0);
+	assert(cache.hits == 1 && cache.misses == 2);
+
+	/* Pattern 1 is now the least recently used, so this
+	 * evicts it, and keeps pattern 0.  */
+	get_and_check(&cache, 2);
+	assert(cache.hits == 1 && cache.misses == 3);
+	assert(get_and_check(&cache, 0) == decoder0);
+	assert(cache.hits == 2 && cache.misses == 3);
+	get_and_check(&cache, 1);
+	assert(cache.hits == 2 && cache.misses == 4);
+
+	free(storage);
+	for (i = 0; i < NUM_PARITY; ++i) {
+		free(parity_blocks[i]);
+		free(recovered_blocks[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,136 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#undef NDEBUG
+#include"raid/llr_decoder.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_xorgf.h"
+#include"raid/llr_xorgf_ones.h"
+#include"userspace/llr_testvectors.h"
+#include<assert.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This test checks that weighted decoders recover the lost
+data, are never costlier than the plain decoder, and stay
+away from parity blocks that are marked expensive.
+*/
+
+#define NUM_DATA 10
+#define NUM_PARITY 4
+
+static void const* data_blocks[NUM_DATA];
+static void* parity_blocks[NUM_PARITY];
+static void* recovered_blocks[NUM_PARITY];
+static unsigned char* garbage;
+
+static unsigned int
+cost(llr_decoder const* decoder) {
+	unsigned int i;
+	unsigned int total = 0;
+	if (decoder->type != llr_decoder_type_multi)
+		return 8 * decoder->num_remaining;
+	for (i = 0; i < decoder->num_remaining * decoder->num_lost_data_blocks; ++i)
+		total += llr_xorgf_ones[decoder->matrix[i]];
+	return total;
+}
+
+static void
+test_weighted(unsigned int const* lost_data, unsigned int num_lost_data,
+	      unsigned int const* lost_parity, unsigned int num_lost_parity,
+	      unsigned int const* parity_costs) {
+	void const* remaining_blocks[NUM_DATA + NUM_PARITY];
+	unsigned char* matrix_storage[2];
+	unsigned char* scratch_space[2];
+	unsigned int matrix_storage_size, scratch_space_size;
+	llr_decoder decoder, plain;
+	unsigned int i, j, l, r;
+
+	r = 0;
+	for (i = 0, l = 0; i < NUM_DATA; ++i) {
+		if (l < num_lost_data && lost_data[l] == i)
+			++l;
+		else
+			remaining_blocks[r++] = data_blocks[i];
+	}
+	for (j = 0, l = 0; j < NUM_PARITY; ++j) {
+		if (l < num_lost_parity && lost_parity[l] == j)
+			++l;
+		/* Expensive parity blocks must not be read.  */
+		else if (parity_costs && parity_costs[j] > 1000)
+			remaining_blocks[r++] = garbage;
+		else
+			remaining_blocks[r++] = parity_blocks[j];
+	}
+
+	llr_decoder_weighted_sizes(&matrix_storage_size, &scratch_space_size,
+				   NUM_DATA, NUM_PARITY,
+				   lost_data, num_lost_data,
+				   lost_parity, num_lost_parity);
+	matrix_storage[0] = malloc(matrix_storage_size + 1);
+	scratch_space[0] = malloc(scratch_space_size + 1);
+	llr_decoder_weighted_init(&decoder, NUM_DATA, NUM_PARITY,
+				  lost_data, num_lost_data,
+				  lost_parity, num_lost_parity,
+				  parity_costs,
+				  matrix_storage[0], scratch_space[0]);
+	llr_decoder_decode(&decoder, recovered_blocks, remaining_blocks);
+	for (l = 0; l < num_lost_data; ++l)
+		assert(0 == memcmp(recovered_blocks[l], data_blocks[lost_data[l]],
+				   LLR_XORGF_BLOCK_SIZE));
+
+	if (!parity_costs) {
+		llr_decoder_sizes(&matrix_storage_size, &scratch_space_size,
+				  NUM_DATA, NUM_PARITY,
+				  lost_data, num_lost_data,
+				  lost_parity, num_lost_parity);
+		matrix_storage[1] = malloc(matrix_storage_size + 1);
+		scratch_space[1] = malloc(scratch_space_size + 1);
+		llr_decoder_init(&plain, NUM_DATA, NUM_PARITY,
+				 lost_data, num_lost_data,
+				 lost_parity, num_lost_parity,
+				 matrix_storage[1], scratch_space[1]);
+		assert(cost(&decoder) <= cost(&plain));
+		free(scratch_space[1]);
+		free(matrix_storage[1]);
+	}
+
+	free(scratch_space[0]);
+	free(matrix_storage[0]);
+}
+
+int main(void) {
+	static unsigned int const lost_0[] = { 0 };
+	static unsigned int const lost_3[] = { 3 };
+	static unsigned int const lost_2_7[] = { 2, 7 };
+	static unsigned int const lost_0_1_4_9[] = { 0, 1, 4, 9 };
+	static unsigned int const busy_0[] = { 5000, 0, 0, 0 };
+	static unsigned int const busy_1_2[] = { 0, 5000, 5000, 0 };
+	unsigned int i, j;
+
+	for (i = 0; i < NUM_DATA; ++i)
+		data_blocks[i] = llr_testvectors_sampledata[(i * 3) % 8];
+	for (j = 0; j < NUM_PARITY; ++j) {
+		parity_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+		recovered_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+	}
+	garbage = malloc(LLR_XORGF_BLOCK_SIZE);
+	memset(garbage, 0xEE, LLR_XORGF_BLOCK_SIZE);
+	llr_encode(data_blocks, NUM_DATA, parity_blocks, NUM_PARITY);
+
+	test_weighted(lost_3, 1, NULL, 0, NULL);
+	test_weighted(lost_3, 1, NULL, 0, busy_0);
+	test_weighted(lost_2_7, 2, NULL, 0, NULL);
+	test_weighted(lost_2_7, 2, lost_0, 1, NULL);
+	test_weighted(lost_2_7, 2, NULL, 0, busy_1_2);
+	/* No choice at all.  */
+	test_weighted(lost_0_1_4_9, 4, NULL, 0, NULL);
+
+	free(garbage);
+	for (j = 0; j < NUM_PARITY; ++j) {
+		free(recovered_blocks[j]);
+		free(parity_blocks[j]);
+	}
+	return 0;
+}
@@ -0,0 +1,202 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#undef NDEBUG
+#include"raid/llr_encode.h"
+#include"raid/llr_encoder.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<assert.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This test checks the alternative encoding and parity
+update entry points, the incremental encoder object, and
+encode plans against plain llr_encode.
+*/
+
+#define MAX_DATA 32
+#define MAX_PARITY 8
+
+static void const* data_blocks[MAX_DATA];
+static void* expected[MAX_PARITY];
+static void* actual[MAX_PARITY];
+
+static void
+setup(unsigned int num_data_blocks) {
+	unsigned int i;
+	for (i = 0; i < num_data_blocks; ++i) {
+		/* Sprinkle in some all-0 blocks.  */
+		if (i % 5 == 3)
+			data_blocks[i] = NULL;
+		else
+			data_blocks[i] = llr_testvectors_sampledata[(i * 3) % 8];
+	}
+}
+
+static void
+test_fused(unsigned int num_data_blocks, unsigned int num_parity_blocks) {
+	unsigned int j;
+
+	setup(num_data_blocks);
+	llr_encode(data_blocks, num_data_blocks,
+		   expected, num_parity_blocks);
+	for (j = 0; j < num_parity_blocks; ++j)
+		memset(actual[j], 0xA5, LLR_XORGF_BLOCK_SIZE);
+	llr_encode_fused(data_blocks, num_data_blocks,
+			 actual, num_parity_blocks);
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(0 == memcmp(expected[j], actual[j], LLR_XORGF_BLOCK_SIZE));
+}
+
+/* Update every third data block, and check against
+ * encoding the new data from scratch.  */
+static void
+test_update(unsigned int num_data_blocks, unsigned int num_parity_blocks) {
+	void const* old_blocks[MAX_DATA];
+	void const* new_blocks[MAX_DATA];
+	unsigned int idxs[MAX_DATA];
+	unsigned int num_updates = 0;
+	unsigned int i, j;
+
+	for (i = 0; i < num_data_blocks; ++i) {
+		data_blocks[i] = llr_testvectors_sampledata[(i * 3) % 8];
+		if (i % 3 == 0) {
+			old_blocks[num_updates] = data_blocks[i];
+			new_blocks[num_updates] =
+				llr_testvectors_sampledata[(i * 3 + 1) % 8];
+			idxs[num_updates] = i;
+			++num_updates;
+		}
+	}
+
+	/* One at a time.  */
+	llr_encode(data_blocks, num_data_blocks, actual, num_parity_blocks);
+	for (i = 0; i < num_updates; ++i)
+		llr_encode_update(old_blocks[i], new_blocks[i], idxs[i],
+				  actual, num_parity_blocks);
+	for (i = 0; i < num_updates; ++i)
+		data_blocks[idxs[i]] = new_blocks[i];
+	llr_encode(data_blocks, num_data_blocks, expected, num_parity_blocks);
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(0 == memcmp(expected[j], actual[j], LLR_XORGF_BLOCK_SIZE));
+
+	/* All at once; this time going back to the old data.  */
+	llr_encode_update_n(new_blocks, old_blocks, idxs, num_updates,
+			    actual, num_parity_blocks);
+	for (i = 0; i < num_updates; ++i)
+		data_blocks[idxs[i]] = old_blocks[i];
+	llr_encode(data_blocks, num_data_blocks, expected, num_parity_blocks);
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(0 == memcmp(expected[j], actual[j], LLR_XORGF_BLOCK_SIZE));
+}
+
+static void
+test_plan(unsigned int num_data_blocks, unsigned int num_parity_blocks) {
+	llr_encode_plan plan;
+	void* storage;
+	enum llr_xorgf_kernels kernels;
+	unsigned int j;
+
+	setup(num_data_blocks);
+	llr_encode(data_blocks, num_data_blocks,
+		   expected, num_parity_blocks);
+	storage = malloc(llr_encode_plan_size(num_data_blocks,
+					      num_parity_blocks));
+	llr_encode_plan_init(&plan, num_data_blocks, num_parity_blocks,
+			     storage);
+	for (j = 0; j < num_parity_blocks; ++j)
+		memset(actual[j], 0xA5, LLR_XORGF_BLOCK_SIZE);
+	llr_encode_plan_run(&plan, data_blocks, actual);
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(0 == memcmp(expected[j], actual[j], LLR_XORGF_BLOCK_SIZE));
+
+	/* Still correct after switching variants.  */
+	llr_xorgf_set_isa(llr_xorgf_isa_generic);
+	for (j = 0; j < num_parity_blocks; ++j)
+		memset(actual[j], 0xA5, LLR_XORGF_BLOCK_SIZE);
+	llr_encode_plan_run(&plan, data_blocks, actual);
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(0 == memcmp(expected[j], actual[j], LLR_XORGF_BLOCK_SIZE));
+	llr_xorgf_init();
+
+	/* And after switching kernel styles.  */
+	kernels = llr_xorgf_get_kernels();
+	llr_xorgf_set_kernels(kernels == llr_xorgf_kernels_unrolled
+			      ? llr_xorgf_kernels_compact
+			      : llr_xorgf_kernels_unrolled);
+	for (j = 0; j < num_parity_blocks; ++j)
+		memset(actual[j], 0xA5, LLR_XORGF_BLOCK_SIZE);
+	llr_encode_plan_run(&plan, data_blocks, actual);
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(0 == memcmp(expected[j], actual[j], LLR_XORGF_BLOCK_SIZE));
+	llr_xorgf_set_kernels(kernels);
+
+	free(storage);
+}
+
+/* Add the data blocks to an encoder out of order.  */
+static void
+test_encoder(unsigned int num_data_blocks, unsigned int num_parity_blocks) {
+	llr_encoder encoder;
+	unsigned int i, j;
+
+	setup(num_data_blocks);
+	llr_encode(data_blocks, num_data_blocks,
+		   expected, num_parity_blocks);
+	for (j = 0; j < num_parity_blocks; ++j)
+		memset(actual[j], 0xA5, LLR_XORGF_BLOCK_SIZE);
+	llr_encoder_init(&encoder, actual, num_parity_blocks);
+	/* Odd indices downwards, then even ones upwards.  */
+	for (i = num_data_blocks; i-- > 0;) {
+		if (i % 2 == 1)
+			llr_encoder_add(&encoder, data_blocks[i], i);
+	}
+	for (i = 0; i < num_data_blocks; i += 2)
+		llr_encoder_add(&encoder, data_blocks[i], i);
+	llr_encoder_finish(&encoder);
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(0 == memcmp(expected[j], actual[j], LLR_XORGF_BLOCK_SIZE));
+}
+
+int main(void) {
+	unsigned int j;
+
+	for (j = 0; j < MAX_PARITY; ++j) {
+		expected[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+		actual[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+	}
+
+	test_fused(0, 2);
+	test_fused(1, 1);
+	test_fused(1, 3);
+	test_fused(3, 2);
+	test_fused(4, 1);
+	test_fused(8, 2);
+	test_fused(16, 4);
+	test_fused(32, 8);
+
+	test_update(1, 1);
+	test_update(3, 2);
+	test_update(8, 2);
+	test_update(16, 4);
+	test_update(32, 8);
+
+	test_plan(1, 1);
+	test_plan(4, 1);
+	test_plan(8, 2);
+	test_plan(10, 4);
+	test_plan(32, 8);
+
+	test_encoder(0, 2);
+	test_encoder(1, 1);
+	test_encoder(5, 3);
+	test_encoder(32, 8);
+
+	for (j = 0; j < MAX_PARITY; ++j) {
+		free(actual[j]);
+		free(expected[j]);
+	}
+	return 0;
+}
@@ -0,0 +1,169 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#undef NDEBUG
+#include"raid/llr_decoder.h"
+#include"raid/llr_lrc.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<assert.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This test checks that LRC decoders recover lost data and
+parity blocks, that single losses only read their group,
+and that unrecoverable patterns are reported.
+*/
+
+#define NUM_DATA 20
+#define NUM_GROUPS 4
+#define NUM_GLOBAL 3
+
+static void const* data_blocks[NUM_DATA];
+static void* local_blocks[NUM_GROUPS];
+static void* global_blocks[NUM_GLOBAL];
+static void* recovered_blocks[NUM_DATA + NUM_GROUPS + NUM_GLOBAL];
+
+static int
+contains(unsigned int const* list, unsigned int n, unsigned int idx) {
+	unsigned int t;
+	for (t = 0; t < n; ++t) {
+		if (list[t] == idx)
+			return 1;
+	}
+	return 0;
+}
+
+/* Decode the given losses; return the number of remaining
+ * blocks read, or -1 if the decoder refused.  */
+static int
+test_lrc(unsigned int const* lost_data, unsigned int num_lost_data,
+	 unsigned int const* lost_local, unsigned int num_lost_local,
+	 unsigned int const* lost_global, unsigned int num_lost_global) {
+	void const* remaining_blocks[NUM_DATA + NUM_GROUPS + NUM_GLOBAL];
+	unsigned char* matrix_storage;
+	unsigned char* scratch_space;
+	unsigned int matrix_storage_size, scratch_space_size;
+	llr_decoder decoder;
+	unsigned int i, r, l, num_remaining;
+	int used = 0;
+
+	r = 0;
+	for (i = 0; i < NUM_DATA; ++i) {
+		if (!contains(lost_data, num_lost_data, i))
+			remaining_blocks[r++] = data_blocks[i];
+	}
+	for (i = 0; i < NUM_GROUPS; ++i) {
+		if (!contains(lost_local, num_lost_local, i))
+			remaining_blocks[r++] = local_blocks[i];
+	}
+	for (i = 0; i < NUM_GLOBAL; ++i) {
+		if (!contains(lost_global, num_lost_global, i))
+			remaining_blocks[r++] = global_blocks[i];
+	}
+	num_remaining = r;
+
+	llr_lrc_decoder_sizes(&matrix_storage_size, &scratch_space_size,
+			      NUM_DATA, NUM_GROUPS, NUM_GLOBAL,
+			      lost_data, num_lost_data,
+			      lost_local, num_lost_local,
+			      lost_global, num_lost_global);
+	matrix_storage = malloc(matrix_storage_size + 1);
+	scratch_space = malloc(scratch_space_size + 1);
+	if (llr_lrc_decoder_init(&decoder, NUM_DATA, NUM_GROUPS, NUM_GLOBAL,
+				 lost_data, num_lost_data,
+				 lost_local, num_lost_local,
+				 lost_global, num_lost_global,
+				 matrix_storage, scratch_space) != 0) {
+		free(scratch_space);
+		free(matrix_storage);
+		return -1;
+	}
+	assert(decoder.num_remaining == num_remaining);
+
+	/* Blocks the decoder does not use are not read.  */
+	for (r = 0; r < num_remaining; ++r) {
+		if (llr_decoder_uses_block(&decoder, r))
+			++used;
+		else
+			remaining_blocks[r] = NULL;
+	}
+
+	llr_decoder_decode(&decoder, recovered_blocks, remaining_blocks);
+	r = 0;
+	for (l = 0; l < num_lost_data; ++l, ++r)
+		assert(0 == memcmp(recovered_blocks[r], data_blocks[lost_data[l]],
+				   LLR_XORGF_BLOCK_SIZE));
+	for (l = 0; l < num_lost_local; ++l, ++r)
+		assert(0 == memcmp(recovered_blocks[r], local_blocks[lost_local[l]],
+				   LLR_XORGF_BLOCK_SIZE));
+	for (l = 0; l < num_lost_global; ++l, ++r)
+		assert(0 == memcmp(recovered_blocks[r], global_blocks[lost_global[l]],
+				   LLR_XORGF_BLOCK_SIZE));
+
+	free(scratch_space);
+	free(matrix_storage);
+	return used;
+}
+
+int main(void) {
+	static unsigned int const none[] = { 0 };
+	static unsigned int const lost_0[] = { 0 };
+	static unsigned int const lost_1[] = { 1 };
+	static unsigned int const lost_2[] = { 2 };
+	static unsigned int const lost_7[] = { 7 };
+	static unsigned int const lost_0_2[] = { 0, 2 };
+	static unsigned int const lost_3_12[] = { 3, 12 };
+	static unsigned int const lost_5_6_7[] = { 5, 6, 7 };
+	static unsigned int const lost_0_to_4[] = { 0, 1, 2, 3, 4 };
+	static unsigned int const lost_0_to_3[] = { 0, 1, 2, 3 };
+	unsigned int i;
+
+	for (i = 0; i < NUM_DATA; ++i)
+		data_blocks[i] = llr_testvectors_sampledata[(i * 3) % 8];
+	for (i = 0; i < NUM_GROUPS; ++i)
+		local_blocks[i] = malloc(LLR_XORGF_BLOCK_SIZE);
+	for (i = 0; i < NUM_GLOBAL; ++i)
+		global_blocks[i] = malloc(LLR_XORGF_BLOCK_SIZE);
+	for (i = 0; i < NUM_DATA + NUM_GROUPS + NUM_GLOBAL; ++i)
+		recovered_blocks[i] = malloc(LLR_XORGF_BLOCK_SIZE);
+
+	/* Groups of 5.  */
+	assert(llr_lrc_group_start(NUM_DATA, NUM_GROUPS, 1) == 5);
+	assert(llr_lrc_group_start(NUM_DATA, NUM_GROUPS, NUM_GROUPS) == NUM_DATA);
+	llr_lrc_encode(data_blocks, NUM_DATA, NUM_GROUPS,
+		       local_blocks, global_blocks, NUM_GLOBAL);
+
+	/* A single lost data block only reads its group.  */
+	assert(test_lrc(lost_7, 1, none, 0, none, 0) == 5);
+	/* So does one per group.  */
+	assert(test_lrc(lost_3_12, 2, none, 0, none, 0) == 10);
+	/* A lost local parity block is rebuilt from its group.  */
+	assert(test_lrc(none, 0, lost_2, 1, none, 0) == 5);
+	/* A lost global parity block needs all the data.  */
+	assert(test_lrc(none, 0, none, 0, lost_1, 1) == NUM_DATA);
+	/* Two in a group need a global parity block too.  */
+	assert(test_lrc(lost_0_2, 2, none, 0, none, 0) > 0);
+	/* Data and its local parity.  */
+	assert(test_lrc(lost_7, 1, lost_1, 1, none, 0) > 0);
+	/* Several groups and parity blocks at once.  */
+	assert(test_lrc(lost_5_6_7, 3, lost_0, 1, lost_2, 1) > 0);
+	/* Four in a group: the local and all global parity
+	 * blocks.  */
+	assert(test_lrc(lost_0_to_3, 4, none, 0, none, 0) > 0);
+	/* Three in a group, with its local parity block.  */
+	assert(test_lrc(lost_0_to_3, 3, lost_0, 1, none, 0) > 0);
+	/* One equation short.  */
+	assert(test_lrc(lost_0_to_3, 4, lost_0, 1, none, 0) == -1);
+	assert(test_lrc(lost_0_to_3, 4, none, 0, lost_1, 1) == -1);
+	assert(test_lrc(lost_0_to_4, 5, none, 0, none, 0) == -1);
+
+	for (i = 0; i < NUM_DATA + NUM_GROUPS + NUM_GLOBAL; ++i)
+		free(recovered_blocks[i]);
+	for (i = 0; i < NUM_GLOBAL; ++i)
+		free(global_blocks[i]);
+	for (i = 0; i < NUM_GROUPS; ++i)
+		free(local_blocks[i]);
+	return 0;
+}
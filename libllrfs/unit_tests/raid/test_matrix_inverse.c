@@ -2,9 +2,13 @@
 # include"config.h"
 #endif
 #undef NDEBUG
+#include"raid/llr_cauchy.h"
+#include"raid/llr_gf.h"
 #include"raid/llr_matrix_inverse.h"
 #include<assert.h>
 #include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
 
 static void
 print3x3(unsigned char mat[9]) {
@@ -58,7 +62,56 @@ test3x3(unsigned char a00, unsigned char a10, unsigned char a20,
 	assert(mat[8] == a22);
 }
 
+/* Test a large matrix like the ones the decoder builds:
+ * the rows of the surviving data blocks, which are rows
+ * of the identity matrix, then rows of the Cauchy matrix.
+ * Every third data block is lost, so many diagonals start
+ * out as 0.
+ * The product with the inverse must be the identity.  */
+static void
+test_decoder_matrix(unsigned int w) {
+	unsigned char* mat = malloc(w * w);
+	unsigned char* inv = malloc(w * w);
+	unsigned char* scratch = malloc(llr_matrix_inverse_scratch_space_size(w));
+	unsigned int i, j, k, row, parity;
+
+	memset(mat, 0, w * w);
+	row = 0;
+	for (k = 0; k < w; ++k) {
+		if (k % 3 == 1)
+			continue;
+		mat[k + row * w] = 1;
+		++row;
+	}
+	for (parity = 0; row < w; ++parity, ++row) {
+		for (k = 0; k < w; ++k)
+			mat[k + row * w] = llr_cauchy(k, parity);
+	}
+
+	memcpy(inv, mat, w * w);
+	llr_matrix_inverse_compute(w, scratch, inv);
+
+	for (j = 0; j < w; ++j) {
+		for (i = 0; i < w; ++i) {
+			unsigned char sum = 0;
+			for (k = 0; k < w; ++k)
+				sum = llr_gf_add(sum, llr_gf_mul(mat[k + j * w],
+								 inv[i + k * w]));
+			assert(sum == ((i == j) ? 1 : 0));
+		}
+	}
+
+	free(scratch);
+	free(inv);
+	free(mat);
+}
+
 int main(void) {
+	unsigned int w;
+
+	for (w = 2; w <= 128; w *= 2)
+		test_decoder_matrix(w);
+
 	test3x3(1, 0, 0,
 		0, 1, 0,
 		0, 0, 1);
@@ -0,0 +1,107 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#undef NDEBUG
+#include"raid/llr_decoder.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<assert.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This test checks that a resilver decoder recovers both
+the lost data blocks and the lost parity blocks.
+*/
+
+#define MAX_DATA 10
+#define MAX_PARITY 4
+
+static void const* data_blocks[MAX_DATA];
+static void* parity_blocks[MAX_PARITY];
+static void* recovered_blocks[MAX_PARITY];
+
+static void
+test_resilver(unsigned int num_data_blocks, unsigned int num_parity_blocks,
+	      unsigned int const* lost_data, unsigned int num_lost_data,
+	      unsigned int const* lost_parity, unsigned int num_lost_parity) {
+	void const* remaining_blocks[MAX_DATA + MAX_PARITY];
+	unsigned char* matrix_storage;
+	unsigned char* scratch_space;
+	unsigned int matrix_storage_size, scratch_space_size;
+	llr_decoder decoder;
+	unsigned int i, j, l, r;
+
+	for (i = 0; i < num_data_blocks; ++i)
+		data_blocks[i] = llr_testvectors_sampledata[(i * 5) % 8];
+	llr_encode(data_blocks, num_data_blocks,
+		   parity_blocks, num_parity_blocks);
+
+	/* Surviving data, then surviving parity.  */
+	r = 0;
+	for (i = 0, l = 0; i < num_data_blocks; ++i) {
+		if (l < num_lost_data && lost_data[l] == i)
+			++l;
+		else
+			remaining_blocks[r++] = data_blocks[i];
+	}
+	for (j = 0, l = 0; j < num_parity_blocks; ++j) {
+		if (l < num_lost_parity && lost_parity[l] == j)
+			++l;
+		else
+			remaining_blocks[r++] = parity_blocks[j];
+	}
+
+	llr_decoder_resilver_sizes(&matrix_storage_size, &scratch_space_size,
+				   num_data_blocks, num_parity_blocks,
+				   lost_data, num_lost_data,
+				   lost_parity, num_lost_parity);
+	matrix_storage = malloc(matrix_storage_size + 1);
+	scratch_space = malloc(scratch_space_size + 1);
+	llr_decoder_resilver_init(&decoder, num_data_blocks, num_parity_blocks,
+				  lost_data, num_lost_data,
+				  lost_parity, num_lost_parity,
+				  matrix_storage, scratch_space);
+	llr_decoder_decode(&decoder, recovered_blocks, remaining_blocks);
+
+	for (l = 0; l < num_lost_data; ++l)
+		assert(0 == memcmp(recovered_blocks[l], data_blocks[lost_data[l]],
+				   LLR_XORGF_BLOCK_SIZE));
+	for (l = 0; l < num_lost_parity; ++l)
+		assert(0 == memcmp(recovered_blocks[num_lost_data + l],
+				   parity_blocks[lost_parity[l]],
+				   LLR_XORGF_BLOCK_SIZE));
+
+	free(scratch_space);
+	free(matrix_storage);
+}
+
+int main(void) {
+	static unsigned int const lost_0[] = { 0 };
+	static unsigned int const lost_5[] = { 5 };
+	static unsigned int const lost_1_3[] = { 1, 3 };
+	static unsigned int const lost_2_7[] = { 2, 7 };
+	static unsigned int const lost_0_1_2[] = { 0, 1, 2 };
+	unsigned int j;
+
+	for (j = 0; j < MAX_PARITY; ++j) {
+		parity_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+		recovered_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+	}
+
+	/* Only parity lost.  */
+	test_resilver(MAX_DATA, MAX_PARITY, NULL, 0, lost_1_3, 2);
+	/* Data and the XOR parity.  */
+	test_resilver(MAX_DATA, MAX_PARITY, lost_5, 1, lost_0, 1);
+	test_resilver(MAX_DATA, MAX_PARITY, lost_2_7, 2, lost_1_3, 2);
+	test_resilver(MAX_DATA, MAX_PARITY, lost_0_1_2, 3, lost_1_3 + 1, 1);
+	/* Mirroring.  */
+	test_resilver(1, MAX_PARITY, lost_0, 1, lost_1_3, 2);
+
+	for (j = 0; j < MAX_PARITY; ++j) {
+		free(recovered_blocks[j]);
+		free(parity_blocks[j]);
+	}
+	return 0;
+}
@@ -0,0 +1,204 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#undef NDEBUG
+#include"raid/llr_decoder.h"
+#include"raid/llr_encode.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<assert.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This test checks that encoding and decoding give the same
+results when some blocks are all 0s, whether passed as
+NULL or as buffers of 0s.
+*/
+
+#define MAX_DATA 10
+#define MAX_PARITY 4
+
+static unsigned char* zero_block;
+static void const* data_blocks[MAX_DATA];
+static void* parity_blocks[MAX_PARITY];
+static void* expected_blocks[MAX_PARITY];
+static void* recovered_blocks[MAX_PARITY];
+
+static void
+test_is_zero(void) {
+	unsigned char* block = malloc(LLR_XORGF_BLOCK_SIZE);
+	unsigned int p;
+
+	memset(block, 0, LLR_XORGF_BLOCK_SIZE);
+	assert(llr_xorgf_is_zero(block));
+	for (p = 0; p < LLR_XORGF_BLOCK_SIZE; p += 487) {
+		block[p] = 0x10;
+		assert(!llr_xorgf_is_zero(block));
+		/* Only the slice containing the byte is nonzero.  */
+		assert(!llr_xorgf_is_zero_slice(block,
+						(p % (LLR_XORGF_BLOCK_SIZE / 8)) /
+						LLR_XORGF_SLICE_SIZE *
+						LLR_XORGF_SLICE_SIZE,
+						LLR_XORGF_SLICE_SIZE));
+		assert(llr_xorgf_is_zero_slice(block,
+					       ((p % (LLR_XORGF_BLOCK_SIZE / 8)) /
+						LLR_XORGF_SLICE_SIZE + 1) %
+					       (LLR_XORGF_BLOCK_SIZE / 8 / LLR_XORGF_SLICE_SIZE) *
+					       LLR_XORGF_SLICE_SIZE,
+					       LLR_XORGF_SLICE_SIZE));
+		block[p] = 0;
+	}
+	free(block);
+}
+
+/* Whether data block i is all 0s in the sparse stripe.  */
+static int
+is_sparse(unsigned int i) {
+	return i % 3 != 1;
+}
+
+static void
+test_encode(unsigned int num_data_blocks, unsigned int num_parity_blocks) {
+	unsigned char plan_storage[4096];
+	llr_encode_plan plan;
+	unsigned int i, j;
+
+	/* Add the nonzero blocks one at a time.  */
+	for (j = 0; j < num_parity_blocks; ++j)
+		memset(expected_blocks[j], 0, LLR_XORGF_BLOCK_SIZE);
+	for (i = 0; i < num_data_blocks; ++i) {
+		if (!is_sparse(i))
+			llr_encode_modify(llr_testvectors_sampledata[i % 8], i,
+					  expected_blocks, num_parity_blocks);
+	}
+
+	/* Zeros as buffers, then as NULL.  */
+	for (i = 0; i < num_data_blocks; ++i)
+		data_blocks[i] = is_sparse(i) ? zero_block : llr_testvectors_sampledata[i % 8];
+	llr_encode(data_blocks, num_data_blocks, parity_blocks, num_parity_blocks);
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(0 == memcmp(parity_blocks[j], expected_blocks[j],
+				   LLR_XORGF_BLOCK_SIZE));
+	for (j = 0; j < num_parity_blocks; ++j)
+		memset(parity_blocks[j], 0x5A, LLR_XORGF_BLOCK_SIZE);
+	llr_encode_fused(data_blocks, num_data_blocks, parity_blocks, num_parity_blocks);
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(0 == memcmp(parity_blocks[j], expected_blocks[j],
+				   LLR_XORGF_BLOCK_SIZE));
+
+	for (i = 0; i < num_data_blocks; ++i) {
+		if (is_sparse(i))
+			data_blocks[i] = NULL;
+	}
+	for (j = 0; j < num_parity_blocks; ++j)
+		memset(parity_blocks[j], 0x5A, LLR_XORGF_BLOCK_SIZE);
+	assert(llr_encode_plan_size(num_data_blocks, num_parity_blocks) <=
+	       sizeof(plan_storage));
+	llr_encode_plan_init(&plan, num_data_blocks, num_parity_blocks,
+			     plan_storage);
+	llr_encode_plan_run(&plan, data_blocks, parity_blocks);
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(0 == memcmp(parity_blocks[j], expected_blocks[j],
+				   LLR_XORGF_BLOCK_SIZE));
+}
+
+/* Decode with the sparse data blocks that survive passed
+ * as NULL, and parity 0 passed as a buffer of 0s if it
+ * happens to be.  */
+static void
+test_decode(unsigned int num_data_blocks, unsigned int num_parity_blocks,
+	    unsigned int const* lost_data, unsigned int num_lost_data) {
+	void const* remaining_blocks[MAX_DATA + MAX_PARITY];
+	unsigned char* matrix_storage;
+	unsigned char* scratch_space;
+	unsigned int matrix_storage_size, scratch_space_size;
+	llr_decoder decoder;
+	unsigned int i, j, l, r;
+
+	for (i = 0; i < num_data_blocks; ++i)
+		data_blocks[i] = is_sparse(i) ? NULL : llr_testvectors_sampledata[i % 8];
+	llr_encode(data_blocks, num_data_blocks, parity_blocks, num_parity_blocks);
+
+	r = 0;
+	for (i = 0, l = 0; i < num_data_blocks; ++i) {
+		if (l < num_lost_data && lost_data[l] == i)
+			++l;
+		else
+			remaining_blocks[r++] = data_blocks[i];
+	}
+	for (j = 0; j < num_parity_blocks; ++j)
+		remaining_blocks[r++] = parity_blocks[j];
+
+	llr_decoder_sizes(&matrix_storage_size, &scratch_space_size,
+			  num_data_blocks, num_parity_blocks,
+			  lost_data, num_lost_data, NULL, 0);
+	matrix_storage = malloc(matrix_storage_size + 1);
+	scratch_space = malloc(scratch_space_size + 1);
+	llr_decoder_init(&decoder, num_data_blocks, num_parity_blocks,
+			 lost_data, num_lost_data, NULL, 0,
+			 matrix_storage, scratch_space);
+
+	for (l = 0; l < num_lost_data; ++l)
+		memset(recovered_blocks[l], 0x5A, LLR_XORGF_BLOCK_SIZE);
+	llr_decoder_decode(&decoder, recovered_blocks, remaining_blocks);
+	for (l = 0; l < num_lost_data; ++l) {
+		void const* expected = data_blocks[lost_data[l]];
+		if (!expected)
+			expected = zero_block;
+		assert(0 == memcmp(recovered_blocks[l], expected,
+				   LLR_XORGF_BLOCK_SIZE));
+	}
+
+	for (l = 0; l < num_lost_data; ++l)
+		memset(recovered_blocks[l], 0x5A, LLR_XORGF_BLOCK_SIZE);
+	llr_decoder_decode_range(&decoder, recovered_blocks, remaining_blocks,
+				 0, LLR_XORGF_BLOCK_SIZE);
+	for (l = 0; l < num_lost_data; ++l) {
+		void const* expected = data_blocks[lost_data[l]];
+		if (!expected)
+			expected = zero_block;
+		assert(0 == memcmp(recovered_blocks[l], expected,
+				   LLR_XORGF_BLOCK_SIZE));
+	}
+
+	free(scratch_space);
+	free(matrix_storage);
+}
+
+int main(void) {
+	static unsigned int const lost_0[] = { 0 };
+	static unsigned int const lost_4[] = { 4 };
+	static unsigned int const lost_1_6[] = { 1, 6 };
+	static unsigned int const lost_0_2_7[] = { 0, 2, 7 };
+	unsigned int j;
+
+	zero_block = calloc(1, LLR_XORGF_BLOCK_SIZE);
+	for (j = 0; j < MAX_PARITY; ++j) {
+		parity_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+		expected_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+		recovered_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+	}
+
+	test_is_zero();
+
+	test_encode(MAX_DATA, 1);
+	test_encode(MAX_DATA, MAX_PARITY);
+	test_encode(1, MAX_PARITY);
+
+	/* Mirroring of a block of 0s.  */
+	test_decode(1, 2, lost_0, 1);
+	/* RAID5.  */
+	test_decode(MAX_DATA, 1, lost_4, 1);
+	/* Multiplication by a matrix.  */
+	test_decode(MAX_DATA, MAX_PARITY, lost_1_6, 2);
+	test_decode(MAX_DATA, MAX_PARITY, lost_0_2_7, 3);
+
+	for (j = 0; j < MAX_PARITY; ++j) {
+		free(recovered_blocks[j]);
+		free(expected_blocks[j]);
+		free(parity_blocks[j]);
+	}
+	free(zero_block);
+	return 0;
+}
@@ -0,0 +1,168 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#undef NDEBUG
+#include"raid/llr_encode.h"
+#include"raid/llr_verify.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<assert.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This test checks that llr_verify accepts parity from
+llr_encode, and points at exactly the parity blocks that
+were damaged, and that llr_locate finds a single
+damaged block.
+*/
+
+#define MAX_DATA 20
+#define MAX_PARITY 12
+
+static void const* data_blocks[MAX_DATA];
+static void* parity_blocks[MAX_PARITY];
+static unsigned char* scratch;
+
+static void
+test_verify(unsigned int num_data_blocks, unsigned int num_parity_blocks) {
+	unsigned char mismatches[(MAX_PARITY + 7) / 8];
+	unsigned char* data;
+	unsigned int i, j;
+
+	for (i = 0; i < num_data_blocks; ++i) {
+		/* Sprinkle in some all-0 blocks.  */
+		if (i % 5 == 3)
+			data_blocks[i] = NULL;
+		else
+			data_blocks[i] = llr_testvectors_sampledata[(i * 3) % 8];
+	}
+	llr_encode(data_blocks, num_data_blocks,
+		   parity_blocks, num_parity_blocks);
+
+	/* Good stripe.  */
+	memset(mismatches, 0xFF, sizeof(mismatches));
+	assert(0 == llr_verify(data_blocks, num_data_blocks,
+			       (void const* const*) parity_blocks,
+			       num_parity_blocks, scratch, mismatches));
+	for (j = 0; j < (num_parity_blocks + 7) / 8; ++j)
+		assert(mismatches[j] == 0);
+	assert(0 == llr_verify(data_blocks, num_data_blocks,
+			       (void const* const*) parity_blocks,
+			       num_parity_blocks, scratch, NULL));
+
+	/* Flip one bit in every other parity block.  */
+	for (j = 0; j < num_parity_blocks; j += 2)
+		((unsigned char*) parity_blocks[j])[(j * 517) % LLR_XORGF_BLOCK_SIZE] ^= 0x10;
+	assert(0 != llr_verify(data_blocks, num_data_blocks,
+			       (void const* const*) parity_blocks,
+			       num_parity_blocks, scratch, mismatches));
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(!!(mismatches[j / 8] & (1 << (j % 8))) == (j % 2 == 0));
+	assert(0 != llr_verify(data_blocks, num_data_blocks,
+			       (void const* const*) parity_blocks,
+			       num_parity_blocks, scratch, NULL));
+	for (j = 0; j < num_parity_blocks; j += 2)
+		((unsigned char*) parity_blocks[j])[(j * 517) % LLR_XORGF_BLOCK_SIZE] ^= 0x10;
+
+	/* Damaged data shows up in every parity block.  */
+	data = malloc(LLR_XORGF_BLOCK_SIZE);
+	memcpy(data, llr_testvectors_sampledata[7], LLR_XORGF_BLOCK_SIZE);
+	data[LLR_XORGF_BLOCK_SIZE - 1] ^= 0x01;
+	data_blocks[0] = data;
+	assert(0 != llr_verify(data_blocks, num_data_blocks,
+			       (void const* const*) parity_blocks,
+			       num_parity_blocks, scratch, mismatches));
+	for (j = 0; j < num_parity_blocks; ++j)
+		assert(mismatches[j / 8] & (1 << (j % 8)));
+	free(data);
+}
+
+static void
+test_locate(unsigned int num_data_blocks, unsigned int num_parity_blocks) {
+	unsigned char* locate_scratch;
+	unsigned char* data[2];
+	unsigned int bad, e, j;
+
+	locate_scratch = malloc(llr_locate_scratch_size(num_parity_blocks));
+	data[0] = malloc(LLR_XORGF_BLOCK_SIZE);
+	data[1] = malloc(LLR_XORGF_BLOCK_SIZE);
+	for (e = 0; e < num_data_blocks; ++e)
+		data_blocks[e] = llr_testvectors_sampledata[(e * 3) % 8];
+	llr_encode(data_blocks, num_data_blocks,
+		   parity_blocks, num_parity_blocks);
+
+	assert(llr_locate_clean ==
+	       llr_locate(data_blocks, num_data_blocks,
+			  (void const* const*) parity_blocks, num_parity_blocks,
+			  locate_scratch, &bad));
+
+	/* One bad data block, damaged in several places.  */
+	for (e = 0; e < num_data_blocks; ++e) {
+		void const* orig = data_blocks[e];
+		memcpy(data[0], orig, LLR_XORGF_BLOCK_SIZE);
+		data[0][e] ^= 0x81;
+		data[0][LLR_XORGF_BLOCK_SIZE - 1 - e] ^= 0x04;
+		data_blocks[e] = data[0];
+		bad = ~0U;
+		assert(llr_locate_data ==
+		       llr_locate(data_blocks, num_data_blocks,
+				  (void const* const*) parity_blocks,
+				  num_parity_blocks, locate_scratch, &bad));
+		assert(bad == e);
+		data_blocks[e] = orig;
+	}
+
+	/* One bad parity block.  */
+	for (j = 0; j < num_parity_blocks; ++j) {
+		((unsigned char*) parity_blocks[j])[j * 7] ^= 0x22;
+		bad = ~0U;
+		assert(llr_locate_parity ==
+		       llr_locate(data_blocks, num_data_blocks,
+				  (void const* const*) parity_blocks,
+				  num_parity_blocks, locate_scratch, &bad));
+		assert(bad == j);
+		((unsigned char*) parity_blocks[j])[j * 7] ^= 0x22;
+	}
+
+	/* Two bad data blocks, damaged in different places,
+	 * cannot be explained by either one.  */
+	memcpy(data[0], data_blocks[0], LLR_XORGF_BLOCK_SIZE);
+	memcpy(data[1], data_blocks[1], LLR_XORGF_BLOCK_SIZE);
+	data[0][10] ^= 0x01;
+	data[1][2000] ^= 0x01;
+	data_blocks[0] = data[0];
+	data_blocks[1] = data[1];
+	assert(llr_locate_unknown ==
+	       llr_locate(data_blocks, num_data_blocks,
+			  (void const* const*) parity_blocks, num_parity_blocks,
+			  locate_scratch, &bad));
+
+	free(data[1]);
+	free(data[0]);
+	free(locate_scratch);
+}
+
+int main(void) {
+	unsigned int j;
+
+	scratch = malloc(LLR_XORGF_BLOCK_SIZE);
+	for (j = 0; j < MAX_PARITY; ++j)
+		parity_blocks[j] = malloc(LLR_XORGF_BLOCK_SIZE);
+
+	test_verify(1, 1);
+	test_verify(4, 2);
+	test_verify(16, 3);
+	test_verify(MAX_DATA, 8);
+	/* More parity blocks than fit in scratch at once.  */
+	test_verify(MAX_DATA, MAX_PARITY);
+
+	test_locate(16, 3);
+	/* More syndromes than fit in one scratch block.  */
+	test_locate(MAX_DATA, MAX_PARITY);
+
+	for (j = 0; j < MAX_PARITY; ++j)
+		free(parity_blocks[j]);
+	free(scratch);
+	return 0;
+}
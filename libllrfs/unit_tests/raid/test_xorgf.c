@@ -0,0 +1,177 @@
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#undef NDEBUG
+#include"raid/llr_gf.h"
+#include"raid/llr_xorgf.h"
+#include"userspace/llr_testvectors.h"
+#include<assert.h>
+#include<stdlib.h>
+#include<string.h>
+
+/*
+This test checks the bit-sliced multipliers against
+plain llr_gf_mul.
+
+In the bit-sliced layout, each block is split into 8
+planes, and plane k holds bit k of every element.
+*/
+
+#define PLANE_SIZE (LLR_XORGF_BLOCK_SIZE / 8)
+
+static unsigned char
+get_element(unsigned char const* block, unsigned int p) {
+	unsigned int o = p / 8;
+	unsigned int b = p % 8;
+	unsigned int k;
+	unsigned char v = 0;
+
+	for (k = 0; k < 8; ++k)
+		v |= ((block[k * PLANE_SIZE + o] >> b) & 1) << k;
+	return v;
+}
+
+static void
+test_isa(void) {
+	unsigned int c, p, i, n, offset;
+	void const* srcs[2 * LLR_XORGF_XOR_MAX + 3];
+
+	unsigned char* acc = malloc(LLR_XORGF_BLOCK_SIZE);
+	unsigned char* acc_n = malloc(3 * LLR_XORGF_BLOCK_SIZE);
+	unsigned char* a_n = malloc(3 * LLR_XORGF_BLOCK_SIZE);
+	unsigned char* diff = malloc(LLR_XORGF_BLOCK_SIZE);
+	unsigned char const* a = llr_testvectors_sampledata[1];
+
+	for (i = 0; i < 3; ++i)
+		memcpy(&a_n[i * LLR_XORGF_BLOCK_SIZE],
+		       llr_testvectors_sampledata[i + 2],
+		       LLR_XORGF_BLOCK_SIZE);
+
+	for (c = 0; c < 256; ++c) {
+		/* Every element must be multiplied by c.  */
+		memcpy(acc, llr_testvectors_sampledata[0], LLR_XORGF_BLOCK_SIZE);
+		llr_xorgf_acc_mul(acc, c, a);
+		for (p = 0; p < LLR_XORGF_BLOCK_SIZE; ++p) {
+			unsigned char orig = get_element(llr_testvectors_sampledata[0], p);
+			unsigned char prod = llr_gf_mul(c, get_element(a, p));
+			assert(get_element(acc, p) == llr_gf_add(orig, prod));
+		}
+
+		/* Multi-block version must match block-by-block.  */
+		memset(acc_n, 0x5A, 3 * LLR_XORGF_BLOCK_SIZE);
+		llr_xorgf_acc_mul_n(acc_n, c, a_n, 3 * LLR_XORGF_BLOCK_SIZE);
+		for (i = 0; i < 3; ++i) {
+			memset(acc, 0x5A, LLR_XORGF_BLOCK_SIZE);
+			llr_xorgf_acc_mul(acc, c, &a_n[i * LLR_XORGF_BLOCK_SIZE]);
+			assert(0 == memcmp(acc, &acc_n[i * LLR_XORGF_BLOCK_SIZE],
+					   LLR_XORGF_BLOCK_SIZE));
+		}
+
+		/* Slices must only touch their own part of each
+		 * plane, and together must match the full block.  */
+		memset(acc_n, 0x5A, LLR_XORGF_BLOCK_SIZE);
+		memset(acc, 0x5A, LLR_XORGF_BLOCK_SIZE);
+		llr_xorgf_acc_mul_slice(acc_n, c, a, LLR_XORGF_SLICE_SIZE,
+					LLR_XORGF_SLICE_SIZE);
+		llr_xorgf_acc_mul(acc, c, a);
+		for (p = 0; p < LLR_XORGF_BLOCK_SIZE; ++p) {
+			unsigned int o = p % PLANE_SIZE;
+			if (o >= LLR_XORGF_SLICE_SIZE && o < 2 * LLR_XORGF_SLICE_SIZE)
+				assert(acc_n[p] == acc[p]);
+			else
+				assert(acc_n[p] == 0x5A);
+		}
+		memset(acc_n, 0x5A, LLR_XORGF_BLOCK_SIZE);
+		for (offset = 0; offset < PLANE_SIZE; offset += 2 * LLR_XORGF_SLICE_SIZE)
+			llr_xorgf_acc_mul_slice(acc_n, c, a, offset,
+						2 * LLR_XORGF_SLICE_SIZE);
+		assert(0 == memcmp(acc, acc_n, LLR_XORGF_BLOCK_SIZE));
+
+		/* A range must match the same bytes of the full
+		 * block, across plane boundaries.  */
+		memset(acc_n, 0x5A, LLR_XORGF_BLOCK_SIZE);
+		offset = PLANE_SIZE - LLR_XORGF_SLICE_SIZE;
+		llr_xorgf_acc_mul_range(acc_n, c, a, offset, 3 * LLR_XORGF_SLICE_SIZE);
+		for (p = 0; p < LLR_XORGF_BLOCK_SIZE; ++p) {
+			if (p >= offset && p < offset + 3 * LLR_XORGF_SLICE_SIZE)
+				assert(acc_n[p] == acc[p]);
+			else
+				assert(acc_n[p] == 0x5A);
+		}
+
+		/* Multiplying a difference must match multiplying
+		 * the XOR of the inputs.  */
+		for (p = 0; p < LLR_XORGF_BLOCK_SIZE; ++p)
+			diff[p] = a[p] ^ a_n[p];
+		memset(acc, 0x5A, LLR_XORGF_BLOCK_SIZE);
+		memset(acc_n, 0x5A, LLR_XORGF_BLOCK_SIZE);
+		llr_xorgf_acc_mul(acc, c, diff);
+		llr_xorgf_acc_mul_diff(acc_n, c, a, a_n);
+		assert(0 == memcmp(acc, acc_n, LLR_XORGF_BLOCK_SIZE));
+		memset(acc_n, 0x5A, LLR_XORGF_BLOCK_SIZE);
+		for (offset = 0; offset < PLANE_SIZE; offset += LLR_XORGF_SLICE_SIZE)
+			llr_xorgf_acc_mul_diff_slice(acc_n, c, a, a_n, offset,
+						     LLR_XORGF_SLICE_SIZE);
+		assert(0 == memcmp(acc, acc_n, LLR_XORGF_BLOCK_SIZE));
+	}
+
+	/* Slice copy and clear only touch their own slice.  */
+	memset(acc, 0x5A, LLR_XORGF_BLOCK_SIZE);
+	llr_xorgf_copy_slice(acc, a, LLR_XORGF_SLICE_SIZE, LLR_XORGF_SLICE_SIZE);
+	llr_xorgf_zero_slice(acc, 3 * LLR_XORGF_SLICE_SIZE, LLR_XORGF_SLICE_SIZE);
+	for (p = 0; p < LLR_XORGF_BLOCK_SIZE; ++p) {
+		unsigned int o = p % PLANE_SIZE;
+		if (o >= LLR_XORGF_SLICE_SIZE && o < 2 * LLR_XORGF_SLICE_SIZE)
+			assert(acc[p] == a[p]);
+		else if (o >= 3 * LLR_XORGF_SLICE_SIZE && o < 4 * LLR_XORGF_SLICE_SIZE)
+			assert(acc[p] == 0);
+		else
+			assert(acc[p] == 0x5A);
+	}
+
+	/* N-way XOR must match adding the sources one by one,
+	 * across batch boundaries and with NULL sources.  */
+	for (n = 0; n <= 2 * LLR_XORGF_XOR_MAX + 3; ++n) {
+		for (i = 0; i < n; ++i)
+			srcs[i] = (i % 5 == 4) ? NULL : llr_testvectors_sampledata[i % 8];
+		memset(acc, 0, LLR_XORGF_BLOCK_SIZE);
+		for (i = 0; i < n; ++i) {
+			if (srcs[i])
+				llr_xorgf_acc_mul(acc, 1, srcs[i]);
+		}
+		memset(acc_n, 0x5A, LLR_XORGF_BLOCK_SIZE);
+		llr_xorgf_xor_n(acc_n, srcs, n);
+		assert(0 == memcmp(acc, acc_n, LLR_XORGF_BLOCK_SIZE));
+	}
+
+	free(diff);
+	free(a_n);
+	free(acc_n);
+	free(acc);
+}
+
+int main(void) {
+	enum llr_xorgf_isa best = llr_xorgf_get_isa();
+	enum llr_xorgf_kernels kernels = llr_xorgf_get_kernels();
+	int isa;
+	int k;
+
+	/* Every variant that can run here, in either kernel
+	 * style, must give the same results.  */
+	for (k = llr_xorgf_kernels_unrolled; k <= llr_xorgf_kernels_compact; ++k) {
+		llr_xorgf_set_kernels((enum llr_xorgf_kernels) k);
+		assert(llr_xorgf_get_kernels() == (enum llr_xorgf_kernels) k);
+		for (isa = llr_xorgf_isa_generic; isa <= llr_xorgf_isa_max; ++isa) {
+			if (!llr_xorgf_isa_supported((enum llr_xorgf_isa) isa))
+				continue;
+			llr_xorgf_set_isa((enum llr_xorgf_isa) isa);
+			assert(llr_xorgf_get_isa() == (enum llr_xorgf_isa) isa);
+			assert(llr_xorgf_get_kernels() == (enum llr_xorgf_kernels) k);
+			test_isa();
+		}
+	}
+	llr_xorgf_set_kernels(kernels);
+	llr_xorgf_set_isa(best);
+
+	return 0;
+}
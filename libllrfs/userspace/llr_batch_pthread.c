@@ -0,0 +1,87 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#if defined(HAVE_CONFIG_H)
+# include"config.h"
+#endif
+#include"llr_batch_pthread.h"
+#include<pthread.h>
+#include<time.h>
+
+struct worker_arg {
+	llr_batch_worker_func func;
+	void* arg;
+	unsigned int worker;
+};
+
+static
+void* thread_main(void* varg) {
+	struct worker_arg* warg = (struct worker_arg*) varg;
+	warg->func(warg->arg, warg->worker);
+	return NULL;
+}
+
+static
+void pthread_run(void* ctx,
+		 unsigned int num_workers,
+		 llr_batch_worker_func func,
+		 void* arg) {
+	pthread_t threads[LLR_BATCH_MAX_WORKERS];
+	struct worker_arg wargs[LLR_BATCH_MAX_WORKERS];
+	int started[LLR_BATCH_MAX_WORKERS];
+	unsigned int w;
+
+	(void) ctx;
+
+	for (w = 1; w < num_workers; ++w) {
+		wargs[w].func = func;
+		wargs[w].arg = arg;
+		wargs[w].worker = w;
+		started[w] = pthread_create(&threads[w], NULL,
+					    &thread_main, &wargs[w]) == 0;
+	}
+
+	/* The calling thread is worker 0.
+	 * If a thread could not be started, the other workers
+	 * steal all of its share.  */
+	func(arg, 0);
+
+	for (w = 1; w < num_workers; ++w) {
+		if (started[w])
+			pthread_join(threads[w], NULL);
+	}
+}
+
+static
+unsigned long long pthread_now_ns(void* ctx) {
+	struct timespec ts;
+	(void) ctx;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void llr_batch_pthread_host(struct llr_batch_host* host,
+			    unsigned int num_workers) {
+	host->run = &pthread_run;
+	host->now_ns = &pthread_now_ns;
+	host->ctx = NULL;
+	host->num_workers = num_workers;
+}
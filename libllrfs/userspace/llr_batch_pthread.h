@@ -0,0 +1,50 @@
+/*
+Copyright 2022 raid5atemyhomework
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#if !defined(USERSPACE_LLR_BATCH_PTHREAD_H_)
+#define USERSPACE_LLR_BATCH_PTHREAD_H_
+#include"raid/llr_batch.h"
+
+/*
+This module provides `llr_batch_host` hooks for hosted
+environments with POSIX threads.
+
+Each batch starts its workers on fresh threads, with the
+calling thread acting as worker 0.
+Hosts that already keep a pool of threads should provide
+their own `run` hook that hands the workers to that pool
+instead.
+*/
+
+/** llr_batch_pthread_host
+ *
+ * @brief Fill in hooks that use POSIX threads and
+ * `CLOCK_MONOTONIC`.
+ *
+ * @param host - output, the hooks to fill in.
+ * @param num_workers - input, the number of workers,
+ * including the calling thread.
+ */
+void llr_batch_pthread_host(struct llr_batch_host* host,
+			    unsigned int num_workers);
+
+#endif /* !defined(USERSPACE_LLR_BATCH_PTHREAD_H_) */